@@ -1,7 +1,11 @@
 from .maxflow import (
                         Solver,
                         get_alg_names,
+                        gomory_hu,
+                        grid,
                         ahuja_orlin,
+                        async_push_relabel,
+                        boykov_kolmogorov,
                         dinic,
                         edmonds_karp,
                         parallel_AhujaOrlin_segment,
@@ -1,6 +1,8 @@
-from libc.stdint cimport uint32_t, uint64_t, UINT32_MAX, int32_t
+from libc.stdint cimport uint8_t, uint32_t, uint64_t, UINT32_MAX, int32_t
+from libcpp.vector cimport vector
 import cython
 from maxflow cimport algs
+from cpython.bytes cimport PyBytes_FromStringAndSize, PyBytes_AS_STRING
 
 cdef int __graph_index_next=-1
 
@@ -9,6 +11,120 @@ cpdef int _destroy_graph(int graph_idx):
     return algs.destroy_graph(graph_idx)
 
 
+cpdef int _store_graph_dense(int mode, size_t A_ptr, size_t n, int nthreads=1) except -1:
+    global __graph_index_next
+    algs.store_graph_dense(mode, A_ptr, n, nthreads)
+    __graph_index_next += 1
+    return __graph_index_next
+
+
+cpdef int _store_graph_sparse(int mode, size_t A_ptr, size_t row_ptr, size_t col_ptr, size_t n, size_t m, int nthreads=1) except -1:
+    global __graph_index_next
+    algs.store_graph_sparse(mode, A_ptr, row_ptr, col_ptr, n, m, nthreads)
+    __graph_index_next += 1
+    return __graph_index_next
+
+
+cpdef int _store_graph_csr(int mode, size_t A_ptr, size_t indptr_ptr, size_t indices_ptr, size_t n, bint index64, bint transposed, int nthreads=1, bint index_entries=False) except -1:
+    global __graph_index_next
+    algs.store_graph_csr(mode, A_ptr, indptr_ptr, indices_ptr, n, index64, transposed, nthreads, index_entries)
+    __graph_index_next += 1
+    return __graph_index_next
+
+
+cpdef void _reorder_graph(int graph_idx, int mode, int kind, size_t root, size_t order_ptr, int nthreads=1) except *:
+    algs.reorder_graph(graph_idx, mode, kind, root, order_ptr, nthreads)
+
+
+cpdef void _update_capacities(int graph_idx, int mode, size_t src_ptr, size_t dst_ptr, size_t capacity_ptr, size_t k) except *:
+    algs.update_capacities(graph_idx, mode, src_ptr, dst_ptr, capacity_ptr, k)
+
+
+cpdef tuple _load_dimacs(bytes path, int nthreads=1):
+    global __graph_index_next
+    cdef algs.dimacs_info info = algs.load_dimacs(path, nthreads)
+    __graph_index_next += 1
+    return info.mode, info.n, info.m, info.source, info.sink, __graph_index_next
+
+
+cpdef void _save_graph(int graph_idx, int mode, bytes path) except *:
+    algs.save_graph(graph_idx, mode, path)
+
+
+cpdef bytes _dump_graph(int graph_idx, int mode):
+    cdef size_t size = algs.snapshot_size(graph_idx, mode)
+    cdef bytes data = PyBytes_FromStringAndSize(NULL, size)
+    algs.write_snapshot(graph_idx, mode, PyBytes_AS_STRING(data))
+    return data
+
+
+cpdef tuple _open_graph(bytes path):
+    global __graph_index_next
+    cdef algs.graph_info info = algs.open_graph(path)
+    __graph_index_next += 1
+    return info.mode, info.n, info.m, __graph_index_next
+
+
+cpdef tuple _load_graph_snapshot(bytes data):
+    global __graph_index_next
+    cdef algs.graph_info info = algs.read_snapshot(data, len(data))
+    __graph_index_next += 1
+    return info.mode, info.n, info.m, __graph_index_next
+
+
+cdef class _Array:
+    # An array owned by the C++ side, numpy.asarray wraps it through the buffer protocol without copying.
+    cdef void* ptr
+    cdef const char* format
+    cdef Py_ssize_t itemsize
+    cdef int ndim
+    cdef Py_ssize_t shape[2]
+    cdef Py_ssize_t strides[2]
+
+    cdef void _wrap(self, void* ptr, const char* format, Py_ssize_t itemsize, Py_ssize_t rows, Py_ssize_t cols):
+        # cols == 0 exposes a one dimensional array of rows items.
+        self.ptr, self.format, self.itemsize = ptr, format, itemsize
+        self.ndim = 1 if cols == 0 else 2
+        self.shape[0], self.shape[1] = rows, cols
+        self.strides[0], self.strides[1] = itemsize * (1 if cols == 0 else cols), itemsize
+
+    def __getbuffer__(self, Py_buffer* buffer, int flags):
+        buffer.buf = self.ptr
+        buffer.format = <char*> self.format
+        buffer.internal = NULL
+        buffer.itemsize = self.itemsize
+        buffer.len = self.shape[0] * (1 if self.ndim == 1 else self.shape[1]) * self.itemsize
+        buffer.ndim = self.ndim
+        buffer.obj = self
+        buffer.readonly = 0
+        buffer.shape = self.shape
+        buffer.strides = self.strides
+        buffer.suboffsets = NULL
+
+    def __releasebuffer__(self, Py_buffer* buffer):
+        pass
+
+
+cdef class _MaskArray(_Array):
+    cdef vector[uint8_t] values
+
+
+cdef class _EdgeArray(_Array):
+    cdef vector[uint64_t] values
+
+
+cpdef tuple _min_cut(int graph_idx, int mode, int edge_kind, size_t sink, bint with_edges=False):
+    # Returns the source side mask of the cut and the cut edges as a k x 2 array, empty unless with_edges is set.
+    cdef _MaskArray side = _MaskArray()
+    cdef _EdgeArray edges = _EdgeArray()
+    side.values.reserve(1)
+    edges.values.reserve(2)
+    algs.min_cut(graph_idx, mode, edge_kind, sink, with_edges, side.values, edges.values)
+    side._wrap(side.values.data(), b'?', sizeof(uint8_t), side.values.size(), 0)
+    edges._wrap(edges.values.data(), b'Q', sizeof(uint64_t), edges.values.size() // 2, 2)
+    return side, edges
+
+
 cpdef (size_t, int) _edmonds_karp_dense(int mode, size_t A_ptr, size_t n, size_t source, size_t sink, int graph_idx):
     global __graph_index_next
     cdef size_t max_flow = algs.run_ek_dense(mode, A_ptr, n, source, sink, graph_idx)
@@ -25,33 +141,57 @@ cpdef (size_t, int) _edmonds_karp_sparse(int mode, size_t A_ptr, size_t row_ptr,
     return max_flow, __graph_index_next
 
 
-cpdef (size_t, int) _push_relabel_fifo_dense(int mode, size_t A_ptr, size_t n, size_t source, size_t sink, int graph_idx):
+cpdef (size_t, int) _edmonds_karp_csr(int mode, size_t A_ptr, size_t indptr_ptr, size_t indices_ptr, size_t n, bint index64, bint transposed, size_t source, size_t sink, int graph_idx):
+    global __graph_index_next
+    cdef size_t max_flow = algs.run_ek_csr(mode, A_ptr, indptr_ptr, indices_ptr, n, index64, transposed, source, sink, graph_idx)
+    if graph_idx == -2 or graph_idx == -3:
+        __graph_index_next += 1
+    return max_flow, __graph_index_next
+
+
+cpdef (size_t, int) _push_relabel_fifo_dense(int mode, size_t A_ptr, size_t n, size_t source, size_t sink, int graph_idx, int nthreads=1):
+    global __graph_index_next
+    cdef size_t max_flow = algs.run_prf_dense(mode, A_ptr, n, source, sink, graph_idx, nthreads)
+    if graph_idx == -2 or graph_idx == -3:
+        __graph_index_next += 1
+    return max_flow, __graph_index_next
+
+
+cpdef (size_t, int) _push_relabel_fifo_sparse(int mode, size_t A_ptr, size_t row_ptr, size_t col_ptr, size_t n, size_t m, size_t source, size_t sink, int graph_idx, int nthreads=1):
+    global __graph_index_next
+    cdef size_t max_flow = algs.run_prf_sparse(mode, A_ptr, row_ptr, col_ptr, n, m, source, sink, graph_idx, nthreads)
+    if graph_idx == -2 or graph_idx == -3:
+        __graph_index_next += 1
+    return max_flow, __graph_index_next
+
+
+cpdef (size_t, int) _push_relabel_fifo_csr(int mode, size_t A_ptr, size_t indptr_ptr, size_t indices_ptr, size_t n, bint index64, bint transposed, size_t source, size_t sink, int graph_idx, int nthreads=1):
     global __graph_index_next
-    cdef size_t max_flow = algs.run_prf_dense(mode, A_ptr, n, source, sink, graph_idx)
+    cdef size_t max_flow = algs.run_prf_csr(mode, A_ptr, indptr_ptr, indices_ptr, n, index64, transposed, source, sink, graph_idx, nthreads)
     if graph_idx == -2 or graph_idx == -3:
         __graph_index_next += 1
     return max_flow, __graph_index_next
 
 
-cpdef (size_t, int) _push_relabel_fifo_sparse(int mode, size_t A_ptr, size_t row_ptr, size_t col_ptr, size_t n, size_t m, size_t source, size_t sink, int graph_idx):
+cpdef (size_t, int) _push_relabel_highest_dense(int mode, size_t A_ptr, size_t n, size_t source, size_t sink, int graph_idx, int nthreads=1):
     global __graph_index_next
-    cdef size_t max_flow = algs.run_prf_sparse(mode, A_ptr, row_ptr, col_ptr, n, m, source, sink, graph_idx)
+    cdef size_t max_flow = algs.run_prh_dense(mode, A_ptr, n, source, sink, graph_idx, nthreads)
     if graph_idx == -2 or graph_idx == -3:
         __graph_index_next += 1
     return max_flow, __graph_index_next
 
 
-cpdef (size_t, int) _push_relabel_highest_dense(int mode, size_t A_ptr, size_t n, size_t source, size_t sink, int graph_idx):
+cpdef (size_t, int) _push_relabel_highest_sparse(int mode, size_t A_ptr, size_t row_ptr, size_t col_ptr, size_t n, size_t m, size_t source, size_t sink, int graph_idx, int nthreads=1):
     global __graph_index_next
-    cdef size_t max_flow = algs.run_prh_dense(mode, A_ptr, n, source, sink, graph_idx)
+    cdef size_t max_flow = algs.run_prh_sparse(mode, A_ptr, row_ptr, col_ptr, n, m, source, sink, graph_idx, nthreads)
     if graph_idx == -2 or graph_idx == -3:
         __graph_index_next += 1
     return max_flow, __graph_index_next
 
 
-cpdef (size_t, int) _push_relabel_highest_sparse(int mode, size_t A_ptr, size_t row_ptr, size_t col_ptr, size_t n, size_t m, size_t source, size_t sink, int graph_idx):
+cpdef (size_t, int) _push_relabel_highest_csr(int mode, size_t A_ptr, size_t indptr_ptr, size_t indices_ptr, size_t n, bint index64, bint transposed, size_t source, size_t sink, int graph_idx, int nthreads=1):
     global __graph_index_next
-    cdef size_t max_flow = algs.run_prh_sparse(mode, A_ptr, row_ptr, col_ptr, n, m, source, sink, graph_idx)
+    cdef size_t max_flow = algs.run_prh_csr(mode, A_ptr, indptr_ptr, indices_ptr, n, index64, transposed, source, sink, graph_idx, nthreads)
     if graph_idx == -2 or graph_idx == -3:
         __graph_index_next += 1
     return max_flow, __graph_index_next
@@ -64,6 +204,13 @@ cpdef (size_t, int) _dinic_dense(int mode, size_t A_ptr, size_t n, size_t source
         __graph_index_next += 1
     return max_flow, __graph_index_next
 
+cpdef (size_t, int) _boykov_kolmogorov_dense(int mode, size_t A_ptr, size_t n, size_t source, size_t sink, int graph_idx):
+    global __graph_index_next
+    cdef size_t max_flow = algs.run_bk_dense(mode, A_ptr, n, source, sink, graph_idx)
+    if graph_idx == -2 or graph_idx == -3:
+        __graph_index_next += 1
+    return max_flow, __graph_index_next
+
 
 cpdef (size_t, int) _dinic_sparse(int mode, size_t A_ptr, size_t row_ptr, size_t col_ptr, size_t n, size_t m, size_t source, size_t sink, int graph_idx):
     global __graph_index_next
@@ -72,18 +219,48 @@ cpdef (size_t, int) _dinic_sparse(int mode, size_t A_ptr, size_t row_ptr, size_t
         __graph_index_next += 1
     return max_flow, __graph_index_next
 
+cpdef (size_t, int) _boykov_kolmogorov_sparse(int mode, size_t A_ptr, size_t row_ptr, size_t col_ptr, size_t n, size_t m, size_t source, size_t sink, int graph_idx):
+    global __graph_index_next
+    cdef size_t max_flow = algs.run_bk_sparse(mode, A_ptr, row_ptr, col_ptr, n, m, source, sink, graph_idx)
+    if graph_idx == -2 or graph_idx == -3:
+        __graph_index_next += 1
+    return max_flow, __graph_index_next
+
+
+cpdef (size_t, int) _dinic_csr(int mode, size_t A_ptr, size_t indptr_ptr, size_t indices_ptr, size_t n, bint index64, bint transposed, size_t source, size_t sink, int graph_idx):
+    global __graph_index_next
+    cdef size_t max_flow = algs.run_din_csr(mode, A_ptr, indptr_ptr, indices_ptr, n, index64, transposed, source, sink, graph_idx)
+    if graph_idx == -2 or graph_idx == -3:
+        __graph_index_next += 1
+    return max_flow, __graph_index_next
 
-cpdef (size_t, int) _ahuja_orlin_dense(int mode, size_t A_ptr, size_t n, size_t source, size_t sink, int graph_idx):
+cpdef (size_t, int) _boykov_kolmogorov_csr(int mode, size_t A_ptr, size_t indptr_ptr, size_t indices_ptr, size_t n, bint index64, bint transposed, size_t source, size_t sink, int graph_idx):
     global __graph_index_next
-    cdef size_t max_flow = algs.run_ao_dense(mode, A_ptr, n, source, sink, graph_idx)
+    cdef size_t max_flow = algs.run_bk_csr(mode, A_ptr, indptr_ptr, indices_ptr, n, index64, transposed, source, sink, graph_idx)
     if graph_idx == -2 or graph_idx == -3:
         __graph_index_next += 1
     return max_flow, __graph_index_next
 
 
-cpdef (size_t, int) _ahuja_orlin_sparse(int mode, size_t A_ptr, size_t row_ptr, size_t col_ptr, size_t n, size_t m, size_t source, size_t sink, int graph_idx):
+cpdef (size_t, int) _ahuja_orlin_dense(int mode, size_t A_ptr, size_t n, size_t source, size_t sink, int graph_idx, int nthreads=1):
     global __graph_index_next
-    cdef size_t max_flow = algs.run_ao_sparse(mode, A_ptr, row_ptr, col_ptr, n, m, source, sink, graph_idx)
+    cdef size_t max_flow = algs.run_ao_dense(mode, A_ptr, n, source, sink, graph_idx, nthreads)
+    if graph_idx == -2 or graph_idx == -3:
+        __graph_index_next += 1
+    return max_flow, __graph_index_next
+
+
+cpdef (size_t, int) _ahuja_orlin_sparse(int mode, size_t A_ptr, size_t row_ptr, size_t col_ptr, size_t n, size_t m, size_t source, size_t sink, int graph_idx, int nthreads=1):
+    global __graph_index_next
+    cdef size_t max_flow = algs.run_ao_sparse(mode, A_ptr, row_ptr, col_ptr, n, m, source, sink, graph_idx, nthreads)
+    if graph_idx == -2 or graph_idx == -3:
+        __graph_index_next += 1
+    return max_flow, __graph_index_next
+
+
+cpdef (size_t, int) _ahuja_orlin_csr(int mode, size_t A_ptr, size_t indptr_ptr, size_t indices_ptr, size_t n, bint index64, bint transposed, size_t source, size_t sink, int graph_idx, int nthreads=1):
+    global __graph_index_next
+    cdef size_t max_flow = algs.run_ao_csr(mode, A_ptr, indptr_ptr, indices_ptr, n, index64, transposed, source, sink, graph_idx, nthreads)
     if graph_idx == -2 or graph_idx == -3:
         __graph_index_next += 1
     return max_flow, __graph_index_next
@@ -105,6 +282,14 @@ cpdef (size_t, int) _parallel_push_relabel_sparse(int mode, size_t A_ptr, size_t
     return max_flow, __graph_index_next
 
 
+cpdef (size_t, int) _parallel_push_relabel_csr(int mode, size_t A_ptr, size_t indptr_ptr, size_t indices_ptr, size_t n, bint index64, bint transposed, size_t source, size_t sink, int graph_idx, int nthreads=1):
+    global __graph_index_next
+    cdef size_t max_flow = algs.run_ppr_csr(mode, A_ptr, indptr_ptr, indices_ptr, n, index64, transposed, source, sink, graph_idx, nthreads)
+    if graph_idx == -2 or graph_idx == -3:
+        __graph_index_next += 1
+    return max_flow, __graph_index_next
+
+
 cpdef (size_t, int) _parallel_push_relabel_segment_dense(int mode, size_t A_ptr, size_t n, size_t source, size_t sink, int graph_idx, int nthreads=1):
     global __graph_index_next
     cdef size_t max_flow = algs.run_pprs_dense(mode, A_ptr, n, source, sink, graph_idx, nthreads)
@@ -121,6 +306,14 @@ cpdef (size_t, int) _parallel_push_relabel_segment_sparse(int mode, size_t A_ptr
     return max_flow, __graph_index_next
 
 
+cpdef (size_t, int) _parallel_push_relabel_segment_csr(int mode, size_t A_ptr, size_t indptr_ptr, size_t indices_ptr, size_t n, bint index64, bint transposed, size_t source, size_t sink, int graph_idx, int nthreads=1):
+    global __graph_index_next
+    cdef size_t max_flow = algs.run_pprs_csr(mode, A_ptr, indptr_ptr, indices_ptr, n, index64, transposed, source, sink, graph_idx, nthreads)
+    if graph_idx == -2 or graph_idx == -3:
+        __graph_index_next += 1
+    return max_flow, __graph_index_next
+
+
 cpdef (size_t, int) _parallel_AhujaOrlin_segment_dense(int mode, size_t A_ptr, size_t n, size_t source, size_t sink, int graph_idx, int nthreads=1):
     global __graph_index_next
     cdef size_t max_flow = algs.run_paos_dense(mode, A_ptr, n, source, sink, graph_idx, nthreads)
@@ -128,6 +321,13 @@ cpdef (size_t, int) _parallel_AhujaOrlin_segment_dense(int mode, size_t A_ptr, s
         __graph_index_next += 1
     return max_flow, __graph_index_next
 
+cpdef (size_t, int) _async_push_relabel_dense(int mode, size_t A_ptr, size_t n, size_t source, size_t sink, int graph_idx, int nthreads=1):
+    global __graph_index_next
+    cdef size_t max_flow = algs.run_apr_dense(mode, A_ptr, n, source, sink, graph_idx, nthreads)
+    if graph_idx == -2 or graph_idx == -3:
+        __graph_index_next += 1
+    return max_flow, __graph_index_next
+
 
 cpdef (size_t, int) _parallel_AhujaOrlin_segment_sparse(int mode, size_t A_ptr, size_t row_ptr, size_t col_ptr, size_t n, size_t m, size_t source, size_t sink, int graph_idx, int nthreads=1):
     global __graph_index_next
@@ -136,12 +336,151 @@ cpdef (size_t, int) _parallel_AhujaOrlin_segment_sparse(int mode, size_t A_ptr,
         __graph_index_next += 1
     return max_flow, __graph_index_next
 
+cpdef (size_t, int) _async_push_relabel_sparse(int mode, size_t A_ptr, size_t row_ptr, size_t col_ptr, size_t n, size_t m, size_t source, size_t sink, int graph_idx, int nthreads=1):
+    global __graph_index_next
+    cdef size_t max_flow = algs.run_apr_sparse(mode, A_ptr, row_ptr, col_ptr, n, m, source, sink, graph_idx, nthreads)
+    if graph_idx == -2 or graph_idx == -3:
+        __graph_index_next += 1
+    return max_flow, __graph_index_next
+
+
+cpdef (size_t, int) _parallel_AhujaOrlin_segment_csr(int mode, size_t A_ptr, size_t indptr_ptr, size_t indices_ptr, size_t n, bint index64, bint transposed, size_t source, size_t sink, int graph_idx, int nthreads=1):
+    global __graph_index_next
+    cdef size_t max_flow = algs.run_paos_csr(mode, A_ptr, indptr_ptr, indices_ptr, n, index64, transposed, source, sink, graph_idx, nthreads)
+    if graph_idx == -2 or graph_idx == -3:
+        __graph_index_next += 1
+    return max_flow, __graph_index_next
+
+cpdef (size_t, int) _async_push_relabel_csr(int mode, size_t A_ptr, size_t indptr_ptr, size_t indices_ptr, size_t n, bint index64, bint transposed, size_t source, size_t sink, int graph_idx, int nthreads=1):
+    global __graph_index_next
+    cdef size_t max_flow = algs.run_apr_csr(mode, A_ptr, indptr_ptr, indices_ptr, n, index64, transposed, source, sink, graph_idx, nthreads)
+    if graph_idx == -2 or graph_idx == -3:
+        __graph_index_next += 1
+    return max_flow, __graph_index_next
+
+
+cpdef void _edmonds_karp_many(int mode, int graph_idx, size_t sources_ptr, size_t sinks_ptr, size_t k, size_t flows_ptr, int nthreads=1) except *:
+    algs.run_ek_many(mode, graph_idx, sources_ptr, sinks_ptr, k, flows_ptr, nthreads)
+
+
+cpdef void _push_relabel_fifo_many(int mode, int graph_idx, size_t sources_ptr, size_t sinks_ptr, size_t k, size_t flows_ptr, int nthreads=1) except *:
+    algs.run_prf_many(mode, graph_idx, sources_ptr, sinks_ptr, k, flows_ptr, nthreads)
+
+
+cpdef void _push_relabel_highest_many(int mode, int graph_idx, size_t sources_ptr, size_t sinks_ptr, size_t k, size_t flows_ptr, int nthreads=1) except *:
+    algs.run_prh_many(mode, graph_idx, sources_ptr, sinks_ptr, k, flows_ptr, nthreads)
+
+
+cpdef void _ahuja_orlin_many(int mode, int graph_idx, size_t sources_ptr, size_t sinks_ptr, size_t k, size_t flows_ptr, int nthreads=1) except *:
+    algs.run_ao_many(mode, graph_idx, sources_ptr, sinks_ptr, k, flows_ptr, nthreads)
+
+
+cpdef void _dinic_many(int mode, int graph_idx, size_t sources_ptr, size_t sinks_ptr, size_t k, size_t flows_ptr, int nthreads=1) except *:
+    algs.run_din_many(mode, graph_idx, sources_ptr, sinks_ptr, k, flows_ptr, nthreads)
+
+cpdef void _boykov_kolmogorov_many(int mode, int graph_idx, size_t sources_ptr, size_t sinks_ptr, size_t k, size_t flows_ptr, int nthreads=1) except *:
+    algs.run_bk_many(mode, graph_idx, sources_ptr, sinks_ptr, k, flows_ptr, nthreads)
+
+
+cpdef void _parallel_push_relabel_many(int mode, int graph_idx, size_t sources_ptr, size_t sinks_ptr, size_t k, size_t flows_ptr, int nthreads=1) except *:
+    algs.run_ppr_many(mode, graph_idx, sources_ptr, sinks_ptr, k, flows_ptr, nthreads)
+
+
+cpdef void _parallel_push_relabel_segment_many(int mode, int graph_idx, size_t sources_ptr, size_t sinks_ptr, size_t k, size_t flows_ptr, int nthreads=1) except *:
+    algs.run_pprs_many(mode, graph_idx, sources_ptr, sinks_ptr, k, flows_ptr, nthreads)
+
+
+cpdef void _parallel_AhujaOrlin_segment_many(int mode, int graph_idx, size_t sources_ptr, size_t sinks_ptr, size_t k, size_t flows_ptr, int nthreads=1) except *:
+    algs.run_paos_many(mode, graph_idx, sources_ptr, sinks_ptr, k, flows_ptr, nthreads)
+
+cpdef void _async_push_relabel_many(int mode, int graph_idx, size_t sources_ptr, size_t sinks_ptr, size_t k, size_t flows_ptr, int nthreads=1) except *:
+    algs.run_apr_many(mode, graph_idx, sources_ptr, sinks_ptr, k, flows_ptr, nthreads)
+
+
+cpdef void _edmonds_karp_gomory_hu(int mode, int graph_idx, size_t parent_ptr, size_t weight_ptr, int nthreads=1) except *:
+    algs.run_ek_gomory_hu(mode, graph_idx, parent_ptr, weight_ptr, nthreads)
+
+
+cpdef void _push_relabel_fifo_gomory_hu(int mode, int graph_idx, size_t parent_ptr, size_t weight_ptr, int nthreads=1) except *:
+    algs.run_prf_gomory_hu(mode, graph_idx, parent_ptr, weight_ptr, nthreads)
+
+
+cpdef void _push_relabel_highest_gomory_hu(int mode, int graph_idx, size_t parent_ptr, size_t weight_ptr, int nthreads=1) except *:
+    algs.run_prh_gomory_hu(mode, graph_idx, parent_ptr, weight_ptr, nthreads)
+
+
+cpdef void _ahuja_orlin_gomory_hu(int mode, int graph_idx, size_t parent_ptr, size_t weight_ptr, int nthreads=1) except *:
+    algs.run_ao_gomory_hu(mode, graph_idx, parent_ptr, weight_ptr, nthreads)
+
+
+cpdef void _dinic_gomory_hu(int mode, int graph_idx, size_t parent_ptr, size_t weight_ptr, int nthreads=1) except *:
+    algs.run_din_gomory_hu(mode, graph_idx, parent_ptr, weight_ptr, nthreads)
+
+cpdef void _boykov_kolmogorov_gomory_hu(int mode, int graph_idx, size_t parent_ptr, size_t weight_ptr, int nthreads=1) except *:
+    algs.run_bk_gomory_hu(mode, graph_idx, parent_ptr, weight_ptr, nthreads)
+
+
+cpdef void _parallel_push_relabel_gomory_hu(int mode, int graph_idx, size_t parent_ptr, size_t weight_ptr, int nthreads=1) except *:
+    algs.run_ppr_gomory_hu(mode, graph_idx, parent_ptr, weight_ptr, nthreads)
+
+
+cpdef void _parallel_push_relabel_segment_gomory_hu(int mode, int graph_idx, size_t parent_ptr, size_t weight_ptr, int nthreads=1) except *:
+    algs.run_pprs_gomory_hu(mode, graph_idx, parent_ptr, weight_ptr, nthreads)
+
+
+cpdef void _parallel_AhujaOrlin_segment_gomory_hu(int mode, int graph_idx, size_t parent_ptr, size_t weight_ptr, int nthreads=1) except *:
+    algs.run_paos_gomory_hu(mode, graph_idx, parent_ptr, weight_ptr, nthreads)
+
+cpdef void _async_push_relabel_gomory_hu(int mode, int graph_idx, size_t parent_ptr, size_t weight_ptr, int nthreads=1) except *:
+    algs.run_apr_gomory_hu(mode, graph_idx, parent_ptr, weight_ptr, nthreads)
+
+
+cpdef size_t _edmonds_karp_flow(int mode, int graph_idx, size_t source, size_t sink, size_t flows_ptr, int nthreads=1) except? 0:
+    return algs.run_ek_flow(mode, graph_idx, source, sink, flows_ptr, nthreads)
+
+
+cpdef size_t _push_relabel_fifo_flow(int mode, int graph_idx, size_t source, size_t sink, size_t flows_ptr, int nthreads=1) except? 0:
+    return algs.run_prf_flow(mode, graph_idx, source, sink, flows_ptr, nthreads)
+
+
+cpdef size_t _push_relabel_highest_flow(int mode, int graph_idx, size_t source, size_t sink, size_t flows_ptr, int nthreads=1) except? 0:
+    return algs.run_prh_flow(mode, graph_idx, source, sink, flows_ptr, nthreads)
+
+
+cpdef size_t _ahuja_orlin_flow(int mode, int graph_idx, size_t source, size_t sink, size_t flows_ptr, int nthreads=1) except? 0:
+    return algs.run_ao_flow(mode, graph_idx, source, sink, flows_ptr, nthreads)
+
+
+cpdef size_t _dinic_flow(int mode, int graph_idx, size_t source, size_t sink, size_t flows_ptr, int nthreads=1) except? 0:
+    return algs.run_din_flow(mode, graph_idx, source, sink, flows_ptr, nthreads)
+
+cpdef size_t _boykov_kolmogorov_flow(int mode, int graph_idx, size_t source, size_t sink, size_t flows_ptr, int nthreads=1) except? 0:
+    return algs.run_bk_flow(mode, graph_idx, source, sink, flows_ptr, nthreads)
+
+
+cpdef size_t _parallel_push_relabel_flow(int mode, int graph_idx, size_t source, size_t sink, size_t flows_ptr, int nthreads=1) except? 0:
+    return algs.run_ppr_flow(mode, graph_idx, source, sink, flows_ptr, nthreads)
+
+
+cpdef size_t _parallel_push_relabel_segment_flow(int mode, int graph_idx, size_t source, size_t sink, size_t flows_ptr, int nthreads=1) except? 0:
+    return algs.run_pprs_flow(mode, graph_idx, source, sink, flows_ptr, nthreads)
+
 
+cpdef size_t _parallel_AhujaOrlin_segment_flow(int mode, int graph_idx, size_t source, size_t sink, size_t flows_ptr, int nthreads=1) except? 0:
+    return algs.run_paos_flow(mode, graph_idx, source, sink, flows_ptr, nthreads)
 
 
+cpdef size_t _async_push_relabel_flow(int mode, int graph_idx, size_t source, size_t sink, size_t flows_ptr, int nthreads=1) except? 0:
+    return algs.run_apr_flow(mode, graph_idx, source, sink, flows_ptr, nthreads)
 
 
+cpdef size_t _push_relabel_highest_grid(int mode, size_t capacities_ptr, size_t terminals_ptr, size_t nx, size_t ny, size_t nz, size_t neighbours, size_t side_ptr, int nthreads=1) except? 0:
+    return algs.run_prh_grid(mode, capacities_ptr, terminals_ptr, nx, ny, nz, neighbours, side_ptr, nthreads)
 
 
+cpdef size_t _boykov_kolmogorov_grid(int mode, size_t capacities_ptr, size_t terminals_ptr, size_t nx, size_t ny, size_t nz, size_t neighbours, size_t side_ptr, int nthreads=1) except? 0:
+    return algs.run_bk_grid(mode, capacities_ptr, terminals_ptr, nx, ny, nz, neighbours, side_ptr, nthreads)
 
 
+cpdef size_t _parallel_push_relabel_grid(int mode, size_t capacities_ptr, size_t terminals_ptr, size_t nx, size_t ny, size_t nz, size_t neighbours, size_t side_ptr, int nthreads=1) except? 0:
+    return algs.run_ppr_grid(mode, capacities_ptr, terminals_ptr, nx, ny, nz, neighbours, side_ptr, nthreads)
@@ -1,23 +1,105 @@
-from libc.stdint cimport uint32_t, uint64_t
+from libc.stdint cimport uint8_t, uint32_t, uint64_t
+from libcpp.vector cimport vector
 
 cdef extern from "../src/maxflow.h":
     size_t run_ek_dense(int mode, size_t A_ptr, size_t n, size_t source, size_t sink, int graph_idx)
-    size_t run_prf_dense(int mode, size_t A_ptr, size_t n, size_t source, size_t sink, int graph_idx)
-    size_t run_prh_dense(int mode, size_t A_ptr, size_t n, size_t source, size_t sink, int graph_idx)
+    size_t run_prf_dense(int mode, size_t A_ptr, size_t n, size_t source, size_t sink, int graph_idx, size_t nthreads)
+    size_t run_prh_dense(int mode, size_t A_ptr, size_t n, size_t source, size_t sink, int graph_idx, size_t nthreads)
     size_t run_din_dense(int mode, size_t A_ptr, size_t n, size_t source, size_t sink, int graph_idx)
-    size_t run_ao_dense(int mode, size_t A_ptr, size_t n, size_t source, size_t sink, int graph_idx)
+    size_t run_bk_dense(int mode, size_t A_ptr, size_t n, size_t source, size_t sink, int graph_idx)
+    size_t run_ao_dense(int mode, size_t A_ptr, size_t n, size_t source, size_t sink, int graph_idx, size_t nthreads)
     size_t run_ppr_dense(int mode, size_t A_ptr, size_t n, size_t source, size_t sink, int graph_idx, size_t nthreads)
     size_t run_pprs_dense(int mode, size_t A_ptr, size_t n, size_t source, size_t sink, int graph_idx, size_t nthreads)
     size_t run_paos_dense(int mode, size_t A_ptr, size_t n, size_t source, size_t sink, int graph_idx, size_t nthreads)
+    size_t run_apr_dense(int mode, size_t A_ptr, size_t n, size_t source, size_t sink, int graph_idx, size_t nthreads)
 
     size_t run_ek_sparse(int mode, size_t A_ptr, size_t row_ptr, size_t col_ptr, size_t n, size_t m, size_t source, size_t sink, int graph_idx)
-    size_t run_prf_sparse(int mode, size_t A_ptr, size_t row_ptr, size_t col_ptr, size_t n, size_t m, size_t source, size_t sink, int graph_idx)
-    size_t run_prh_sparse(int mode, size_t A_ptr, size_t row_ptr, size_t col_ptr, size_t n, size_t m, size_t source, size_t sink, int graph_idx)
+    size_t run_prf_sparse(int mode, size_t A_ptr, size_t row_ptr, size_t col_ptr, size_t n, size_t m, size_t source, size_t sink, int graph_idx, size_t nthreads)
+    size_t run_prh_sparse(int mode, size_t A_ptr, size_t row_ptr, size_t col_ptr, size_t n, size_t m, size_t source, size_t sink, int graph_idx, size_t nthreads)
     size_t run_din_sparse(int mode, size_t A_ptr, size_t row_ptr, size_t col_ptr, size_t n, size_t m, size_t source, size_t sink, int graph_idx)
-    size_t run_ao_sparse(int mode, size_t A_ptr, size_t row_ptr, size_t col_ptr, size_t n, size_t m, size_t source, size_t sink, int graph_idx)
+    size_t run_bk_sparse(int mode, size_t A_ptr, size_t row_ptr, size_t col_ptr, size_t n, size_t m, size_t source, size_t sink, int graph_idx)
+    size_t run_ao_sparse(int mode, size_t A_ptr, size_t row_ptr, size_t col_ptr, size_t n, size_t m, size_t source, size_t sink, int graph_idx, size_t nthreads)
     size_t run_ppr_sparse(int mode, size_t A_ptr, size_t row_ptr, size_t col_ptr, size_t n, size_t m, size_t source, size_t sink, int graph_idx, size_t nthreads)
     size_t run_pprs_sparse(int mode, size_t A_ptr, size_t row_ptr, size_t col_ptr, size_t n, size_t m, size_t source, size_t sink, int graph_idx, size_t nthreads)
     size_t run_paos_sparse(int mode, size_t A_ptr, size_t row_ptr, size_t col_ptr, size_t n, size_t m, size_t source, size_t sink, int graph_idx, size_t nthreads)
+    size_t run_apr_sparse(int mode, size_t A_ptr, size_t row_ptr, size_t col_ptr, size_t n, size_t m, size_t source, size_t sink, int graph_idx, size_t nthreads)
+
+    size_t run_ek_csr(int mode, size_t A_ptr, size_t indptr_ptr, size_t indices_ptr, size_t n, bint index64, bint transposed, size_t source, size_t sink, int graph_idx)
+    size_t run_prf_csr(int mode, size_t A_ptr, size_t indptr_ptr, size_t indices_ptr, size_t n, bint index64, bint transposed, size_t source, size_t sink, int graph_idx, size_t nthreads)
+    size_t run_prh_csr(int mode, size_t A_ptr, size_t indptr_ptr, size_t indices_ptr, size_t n, bint index64, bint transposed, size_t source, size_t sink, int graph_idx, size_t nthreads)
+    size_t run_din_csr(int mode, size_t A_ptr, size_t indptr_ptr, size_t indices_ptr, size_t n, bint index64, bint transposed, size_t source, size_t sink, int graph_idx)
+    size_t run_bk_csr(int mode, size_t A_ptr, size_t indptr_ptr, size_t indices_ptr, size_t n, bint index64, bint transposed, size_t source, size_t sink, int graph_idx)
+    size_t run_ao_csr(int mode, size_t A_ptr, size_t indptr_ptr, size_t indices_ptr, size_t n, bint index64, bint transposed, size_t source, size_t sink, int graph_idx, size_t nthreads)
+    size_t run_ppr_csr(int mode, size_t A_ptr, size_t indptr_ptr, size_t indices_ptr, size_t n, bint index64, bint transposed, size_t source, size_t sink, int graph_idx, size_t nthreads)
+    size_t run_pprs_csr(int mode, size_t A_ptr, size_t indptr_ptr, size_t indices_ptr, size_t n, bint index64, bint transposed, size_t source, size_t sink, int graph_idx, size_t nthreads)
+    size_t run_paos_csr(int mode, size_t A_ptr, size_t indptr_ptr, size_t indices_ptr, size_t n, bint index64, bint transposed, size_t source, size_t sink, int graph_idx, size_t nthreads)
+    size_t run_apr_csr(int mode, size_t A_ptr, size_t indptr_ptr, size_t indices_ptr, size_t n, bint index64, bint transposed, size_t source, size_t sink, int graph_idx, size_t nthreads)
+
+    void store_graph_dense(int mode, size_t A_ptr, size_t n, size_t nthreads) except +
+    void store_graph_sparse(int mode, size_t A_ptr, size_t row_ptr, size_t col_ptr, size_t n, size_t m, size_t nthreads) except +
+    void store_graph_csr(int mode, size_t A_ptr, size_t indptr_ptr, size_t indices_ptr, size_t n, bint index64, bint transposed, size_t nthreads, bint index_entries) except +
+    void reorder_graph(int graph_idx, int mode, int kind, size_t root, size_t order_ptr, size_t nthreads) except +
+
+    void run_ek_many(int mode, int graph_idx, size_t sources_ptr, size_t sinks_ptr, size_t k, size_t flows_ptr, size_t nthreads) except +
+    void run_prf_many(int mode, int graph_idx, size_t sources_ptr, size_t sinks_ptr, size_t k, size_t flows_ptr, size_t nthreads) except +
+    void run_prh_many(int mode, int graph_idx, size_t sources_ptr, size_t sinks_ptr, size_t k, size_t flows_ptr, size_t nthreads) except +
+    void run_ao_many(int mode, int graph_idx, size_t sources_ptr, size_t sinks_ptr, size_t k, size_t flows_ptr, size_t nthreads) except +
+    void run_din_many(int mode, int graph_idx, size_t sources_ptr, size_t sinks_ptr, size_t k, size_t flows_ptr, size_t nthreads) except +
+    void run_bk_many(int mode, int graph_idx, size_t sources_ptr, size_t sinks_ptr, size_t k, size_t flows_ptr, size_t nthreads) except +
+    void run_ppr_many(int mode, int graph_idx, size_t sources_ptr, size_t sinks_ptr, size_t k, size_t flows_ptr, size_t nthreads) except +
+    void run_pprs_many(int mode, int graph_idx, size_t sources_ptr, size_t sinks_ptr, size_t k, size_t flows_ptr, size_t nthreads) except +
+    void run_paos_many(int mode, int graph_idx, size_t sources_ptr, size_t sinks_ptr, size_t k, size_t flows_ptr, size_t nthreads) except +
+    void run_apr_many(int mode, int graph_idx, size_t sources_ptr, size_t sinks_ptr, size_t k, size_t flows_ptr, size_t nthreads) except +
+
+    void run_ek_gomory_hu(int mode, int graph_idx, size_t parent_ptr, size_t weight_ptr, size_t nthreads) except +
+    void run_prf_gomory_hu(int mode, int graph_idx, size_t parent_ptr, size_t weight_ptr, size_t nthreads) except +
+    void run_prh_gomory_hu(int mode, int graph_idx, size_t parent_ptr, size_t weight_ptr, size_t nthreads) except +
+    void run_ao_gomory_hu(int mode, int graph_idx, size_t parent_ptr, size_t weight_ptr, size_t nthreads) except +
+    void run_din_gomory_hu(int mode, int graph_idx, size_t parent_ptr, size_t weight_ptr, size_t nthreads) except +
+    void run_bk_gomory_hu(int mode, int graph_idx, size_t parent_ptr, size_t weight_ptr, size_t nthreads) except +
+    void run_ppr_gomory_hu(int mode, int graph_idx, size_t parent_ptr, size_t weight_ptr, size_t nthreads) except +
+    void run_pprs_gomory_hu(int mode, int graph_idx, size_t parent_ptr, size_t weight_ptr, size_t nthreads) except +
+    void run_paos_gomory_hu(int mode, int graph_idx, size_t parent_ptr, size_t weight_ptr, size_t nthreads) except +
+    void run_apr_gomory_hu(int mode, int graph_idx, size_t parent_ptr, size_t weight_ptr, size_t nthreads) except +
+
+    size_t run_ek_flow(int mode, int graph_idx, size_t source, size_t sink, size_t flows_ptr, size_t nthreads) except +
+    size_t run_prf_flow(int mode, int graph_idx, size_t source, size_t sink, size_t flows_ptr, size_t nthreads) except +
+    size_t run_prh_flow(int mode, int graph_idx, size_t source, size_t sink, size_t flows_ptr, size_t nthreads) except +
+    size_t run_ao_flow(int mode, int graph_idx, size_t source, size_t sink, size_t flows_ptr, size_t nthreads) except +
+    size_t run_din_flow(int mode, int graph_idx, size_t source, size_t sink, size_t flows_ptr, size_t nthreads) except +
+    size_t run_bk_flow(int mode, int graph_idx, size_t source, size_t sink, size_t flows_ptr, size_t nthreads) except +
+    size_t run_ppr_flow(int mode, int graph_idx, size_t source, size_t sink, size_t flows_ptr, size_t nthreads) except +
+    size_t run_pprs_flow(int mode, int graph_idx, size_t source, size_t sink, size_t flows_ptr, size_t nthreads) except +
+    size_t run_paos_flow(int mode, int graph_idx, size_t source, size_t sink, size_t flows_ptr, size_t nthreads) except +
+    size_t run_apr_flow(int mode, int graph_idx, size_t source, size_t sink, size_t flows_ptr, size_t nthreads) except +
+
+    size_t run_prh_grid(int mode, size_t capacities_ptr, size_t terminals_ptr, size_t nx, size_t ny, size_t nz, size_t neighbours, size_t side_ptr, size_t nthreads) except +
+    size_t run_bk_grid(int mode, size_t capacities_ptr, size_t terminals_ptr, size_t nx, size_t ny, size_t nz, size_t neighbours, size_t side_ptr, size_t nthreads) except +
+    size_t run_ppr_grid(int mode, size_t capacities_ptr, size_t terminals_ptr, size_t nx, size_t ny, size_t nz, size_t neighbours, size_t side_ptr, size_t nthreads) except +
+
+    void min_cut(int graph_idx, int mode, int edge_kind, size_t sink, bint with_edges, vector[uint8_t]& side, vector[uint64_t]& edges) except +
+
+    cdef struct dimacs_info:
+        int mode
+        size_t n
+        size_t m
+        size_t source
+        size_t sink
+
+    dimacs_info load_dimacs(const char* path, size_t nthreads) except +
+
+    cdef struct graph_info:
+        int mode
+        size_t n
+        size_t m
+
+    void save_graph(int graph_idx, int mode, const char* path) except +
+    size_t snapshot_size(int graph_idx, int mode) except +
+    void write_snapshot(int graph_idx, int mode, char* buffer) except +
+    graph_info open_graph(const char* path) except +
+    graph_info read_snapshot(const char* data, size_t size) except +
+
+    void update_capacities(int graph_idx, int mode, size_t src_ptr, size_t dst_ptr, size_t capacity_ptr, size_t k) except +
 
     size_t destroy_graph(int graph_idx)
 
@@ -1,78 +1,271 @@
 from ._maxflow import (
                         _ahuja_orlin_dense, 
                         _ahuja_orlin_sparse, 
+                        _ahuja_orlin_csr,
                         _dinic_dense, 
+                        _boykov_kolmogorov_dense,
                         _dinic_sparse, 
+                        _boykov_kolmogorov_sparse,
+                        _dinic_csr,
+                        _boykov_kolmogorov_csr,
                         _edmonds_karp_dense,
                         _edmonds_karp_sparse,
+                        _edmonds_karp_csr,
                         _parallel_AhujaOrlin_segment_dense,
+                        _async_push_relabel_dense,
                         _parallel_AhujaOrlin_segment_sparse,
+                        _async_push_relabel_sparse,
+                        _parallel_AhujaOrlin_segment_csr,
+                        _async_push_relabel_csr,
                         _parallel_push_relabel_dense,
                         _parallel_push_relabel_sparse,
+                        _parallel_push_relabel_csr,
                         _parallel_push_relabel_segment_dense,
                         _parallel_push_relabel_segment_sparse,
+                        _parallel_push_relabel_segment_csr,
                         _push_relabel_fifo_dense,
                         _push_relabel_fifo_sparse,
+                        _push_relabel_fifo_csr,
                         _push_relabel_highest_dense,
                         _push_relabel_highest_sparse,
-                        _destroy_graph
+                        _push_relabel_highest_csr,
+                        _edmonds_karp_many,
+                        _push_relabel_fifo_many,
+                        _push_relabel_highest_many,
+                        _ahuja_orlin_many,
+                        _dinic_many,
+                        _boykov_kolmogorov_many,
+                        _parallel_push_relabel_many,
+                        _parallel_push_relabel_segment_many,
+                        _parallel_AhujaOrlin_segment_many,
+                        _async_push_relabel_many,
+                        _edmonds_karp_gomory_hu,
+                        _push_relabel_fifo_gomory_hu,
+                        _push_relabel_highest_gomory_hu,
+                        _ahuja_orlin_gomory_hu,
+                        _dinic_gomory_hu,
+                        _boykov_kolmogorov_gomory_hu,
+                        _parallel_push_relabel_gomory_hu,
+                        _parallel_push_relabel_segment_gomory_hu,
+                        _parallel_AhujaOrlin_segment_gomory_hu,
+                        _async_push_relabel_gomory_hu,
+                        _edmonds_karp_flow,
+                        _push_relabel_fifo_flow,
+                        _push_relabel_highest_flow,
+                        _ahuja_orlin_flow,
+                        _dinic_flow,
+                        _boykov_kolmogorov_flow,
+                        _parallel_push_relabel_flow,
+                        _parallel_push_relabel_segment_flow,
+                        _parallel_AhujaOrlin_segment_flow,
+                        _async_push_relabel_flow,
+                        _push_relabel_highest_grid,
+                        _boykov_kolmogorov_grid,
+                        _parallel_push_relabel_grid,
+                        _min_cut,
+                        _destroy_graph,
+                        _store_graph_dense,
+                        _store_graph_sparse,
+                        _store_graph_csr,
+                        _update_capacities,
+                        _reorder_graph,
+                        _load_dimacs,
+                        _save_graph,
+                        _dump_graph,
+                        _open_graph,
+                        _load_graph_snapshot
                         )
 
 
+import os
 import types
 import numpy as np
 from scipy import sparse
 
 _alg_params = {
-                "edmonds_karp"                  : (1, _edmonds_karp_dense, _edmonds_karp_sparse, False), 
-                "ahuja_orlin"                   : (2, _ahuja_orlin_dense, _ahuja_orlin_sparse, False),
-                "dinic"                         : (1, _dinic_dense, _dinic_sparse, False),
-                "push_relabel_fifo"             : (2, _push_relabel_fifo_dense, _push_relabel_fifo_sparse, False),
-                "push_relabel_highest"          : (2, _push_relabel_highest_dense, _push_relabel_highest_sparse, False),
-                "parallel_push_relabel"         : (2, _parallel_push_relabel_dense, _parallel_push_relabel_sparse, True),
-                "parallel_push_relabel_segment" : (2, _parallel_push_relabel_segment_dense, _parallel_push_relabel_segment_sparse, True),
-                "parallel_AhujaOrlin_segment"   : (2, _parallel_AhujaOrlin_segment_dense, _parallel_AhujaOrlin_segment_sparse, True),
+                "edmonds_karp"                  : (1, _edmonds_karp_dense, _edmonds_karp_sparse, _edmonds_karp_csr, False, _edmonds_karp_many, _edmonds_karp_gomory_hu, _edmonds_karp_flow), 
+                "ahuja_orlin"                   : (2, _ahuja_orlin_dense, _ahuja_orlin_sparse, _ahuja_orlin_csr, True, _ahuja_orlin_many, _ahuja_orlin_gomory_hu, _ahuja_orlin_flow),
+                "dinic"                         : (1, _dinic_dense, _dinic_sparse, _dinic_csr, False, _dinic_many, _dinic_gomory_hu, _dinic_flow),
+                "boykov_kolmogorov"             : (1, _boykov_kolmogorov_dense, _boykov_kolmogorov_sparse, _boykov_kolmogorov_csr, False, _boykov_kolmogorov_many, _boykov_kolmogorov_gomory_hu, _boykov_kolmogorov_flow),
+                "push_relabel_fifo"             : (2, _push_relabel_fifo_dense, _push_relabel_fifo_sparse, _push_relabel_fifo_csr, True, _push_relabel_fifo_many, _push_relabel_fifo_gomory_hu, _push_relabel_fifo_flow),
+                "push_relabel_highest"          : (2, _push_relabel_highest_dense, _push_relabel_highest_sparse, _push_relabel_highest_csr, True, _push_relabel_highest_many, _push_relabel_highest_gomory_hu, _push_relabel_highest_flow),
+                "parallel_push_relabel"         : (2, _parallel_push_relabel_dense, _parallel_push_relabel_sparse, _parallel_push_relabel_csr, True, _parallel_push_relabel_many, _parallel_push_relabel_gomory_hu, _parallel_push_relabel_flow),
+                "parallel_push_relabel_segment" : (2, _parallel_push_relabel_segment_dense, _parallel_push_relabel_segment_sparse, _parallel_push_relabel_segment_csr, True, _parallel_push_relabel_segment_many, _parallel_push_relabel_segment_gomory_hu, _parallel_push_relabel_segment_flow),
+                "parallel_AhujaOrlin_segment"   : (2, _parallel_AhujaOrlin_segment_dense, _parallel_AhujaOrlin_segment_sparse, _parallel_AhujaOrlin_segment_csr, True, _parallel_AhujaOrlin_segment_many, _parallel_AhujaOrlin_segment_gomory_hu, _parallel_AhujaOrlin_segment_flow),
+                "async_push_relabel"            : (2, _async_push_relabel_dense, _async_push_relabel_sparse, _async_push_relabel_csr, True, _async_push_relabel_many, _async_push_relabel_gomory_hu, _async_push_relabel_flow),
                 }
 
+_grid_algs = {
+                "push_relabel_highest"          : _push_relabel_highest_grid,
+                "boykov_kolmogorov"             : _boykov_kolmogorov_grid,
+                "parallel_push_relabel"         : _parallel_push_relabel_grid,
+                }
+
+
+_store_fns = {1: _store_graph_dense, 2: _store_graph_sparse, 3: _store_graph_csr}
+
+_vertex_orders = {"bfs": 1, "rcm": 2, "degree": 3}
+
+
+def _graph_args(A, mode):
+    # Returns the index of the loader in _alg_params, its arguments describing A, and the arrays they point to.
+    if isinstance(A, np.ndarray):
+        A = np.ascontiguousarray(A)
+        return 1, [mode, A.ctypes.data, A.shape[0]], A
+
+    if A.has_canonical_format:
+        # CSR and CSC arrays are read in place, int32 and int64 indices are both accepted.
+        indptr = A.indptr.astype(A.indices.dtype, copy=False)
+        index64 = A.indices.dtype == np.int64
+        transposed = type(A) is sparse.csc_matrix
+        args = [mode, A.data.ctypes.data, indptr.ctypes.data, A.indices.ctypes.data, A.shape[0], index64, transposed]
+        return 3, args, (A, indptr)
+
+    # Unsorted or duplicate indices are merged by the COO loader.
+    A_coo = A.tocoo(copy=False)
+    return 2, [mode, A_coo.data.ctypes.data, A_coo.row.ctypes.data, A_coo.col.ctypes.data, A_coo.shape[0], A_coo.nnz], A_coo
+
 
 def get_alg_names():
     return list(_alg_params.keys())
 
 
 class Solver:
+    # A loaded graph is kept with its original capacities, every solve runs on its own copy of the residual network.
+    # Any algorithm can solve it, without loading it again.
     def __init__(self):
         self.__graph_idx = None
         self.__mode = None
-        self.alg = None
+        self.__flow_pattern = None
+        self.__order = None
+        self.__rank = None
         self.isLoaded = False
 
-    def load_graph(self, A, alg):
-        if alg not in _alg_params:
+    def load_graph(self, A, alg=None, nthreads=1, flow_index=False, reorder=None, root=0):
+        # alg is optional, the loaded graph can be solved with any algorithm. flow_index keeps the arc of every entry of
+        # A with the graph, which solve(..., return_flow=True) needs. It is not saved with snapshots. reorder renumbers
+        # the vertices internally so that neighbours are stored close together: "bfs" in breadth first order from root,
+        # best with the sink as root, "rcm" in reverse Cuthill-McKee order and "degree" by decreasing degree. Vertices,
+        # cuts and flows are passed and returned in the numbering of A all the same.
+        if alg is not None and alg not in _alg_params:
             raise ValueError("alg must be any one of : [{}]".format(', '.join(_alg_params)))
-        
-        self.__mode = get_mode(A)
-        self.__func_idx = 1
-        
-        if type(A) is sparse.csr.csr_matrix:
-            self.__func_idx = 2
+
+        if reorder is not None and reorder not in _vertex_orders:
+            raise ValueError("reorder must be None or any one of : [{}]".format(', '.join(_vertex_orders)))
+
+        if reorder is not None and ((type(root) != int) or (not (0 <= root < A.shape[0]))):
+            raise ValueError("root must be a non-negative integer smaller than number of vertices")
+
+        mode = get_mode(A)
 
         if self.isLoaded:
             self.destroy_graphs()
 
-        if self.__func_idx == 1:
-            self.n = A.shape[0]
-            self.__graph_idx = _alg_params[alg][1](self.__mode, A.ctypes.data, self.n, 0, 0, -2)[1]
+        self.__mode = mode
+        self.n = A.shape[0]
+        if flow_index:
+            # The flows are returned with the sparsity pattern of A, dense arrays and sparse ones with duplicates are
+            # indexed by their canonical CSR form.
+            if isinstance(A, np.ndarray):
+                A = sparse.csr_matrix(A)
+            elif not A.has_canonical_format:
+                A = A.tocsr(copy=True)
+                A.sum_duplicates()
+            func_idx, args, arrays = _graph_args(A, self.__mode)
+            self.__graph_idx = _store_fns[func_idx](*args, nthreads, True)
+            self.__flow_pattern = (type(A), A.indices.copy(), A.indptr.copy(), A.shape, A.dtype)
         else:
-            A_coo = A.tocoo(copy=False)
-            self.n, m = A_coo.shape[0], A_coo.nnz
-            self.__graph_idx = _alg_params[alg][2](self.__mode, A_coo.data.ctypes.data, A_coo.row.ctypes.data, A_coo.col.ctypes.data, self.n, m, 0, 0, -2)[1]
+            func_idx, args, arrays = _graph_args(A, self.__mode)
+            self.__graph_idx = _store_fns[func_idx](*args, nthreads)
     
         self.isLoaded = True
-        self.alg = alg
+        if reorder is not None:
+            order = np.empty(self.n, dtype=np.uint64)
+            _reorder_graph(self.__graph_idx, self.__mode, _vertex_orders[reorder], root, order.ctypes.data, nthreads)
+            self.__set_order(order.astype(np.int64))
+
+    def __set_order(self, order):
+        # order[i] is the vertex of A numbered i in the loaded graph, rank maps the vertices of A to their numbers.
+        self.__order = order
+        self.__rank = np.empty_like(order)
+        self.__rank[order] = np.arange(order.size)
+
+    def load_dimacs(self, path, nthreads=1):
+        # Reads a max flow problem in the DIMACS format using nthreads threads and returns the (source, sink) declared
+        # in the file, None for a terminal that is not declared.
+        if self.isLoaded:
+            self.destroy_graphs()
+
+        mode, self.n, m, source, sink, self.__graph_idx = _load_dimacs(os.fsencode(path), nthreads)
+        self.__mode = mode
+
+        self.isLoaded = True
+        no_vertex = np.iinfo(np.uint64).max
+        return (None if source == no_vertex else source, None if sink == no_vertex else sink)
+
+    def update_capacities(self, src, dst, new_cap):
+        # Sets the capacity of the arcs src[i] -> dst[i] to new_cap[i], scalars are accepted as well. Only arcs between
+        # vertices adjacent in the loaded graph, in either direction, can be changed. The next solve with the algorithm
+        # and terminals of the previous one continues from its preflow if the algorithm is push_relabel_highest or
+        # ahuja_orlin, so its cost depends on the size of the change rather than the size of the graph.
+        if not self.isLoaded:
+            raise ValueError("Load a graph first using load_graph, load_dimacs or open")
+
+        src, dst, new_cap = (np.atleast_1d(a) for a in np.broadcast_arrays(src, dst, new_cap))
+        if np.any(src < 0) or np.any(dst < 0) or np.any(new_cap < 0):
+            raise ValueError("src, dst and new_cap must be non-negative")
+
+        if self.__rank is not None:
+            if np.any(src >= self.n) or np.any(dst >= self.n):
+                raise ValueError("src and dst must be smaller than number of vertices")
+            src, dst = self.__rank[src], self.__rank[dst]
+
+        src, dst, new_cap = (np.ascontiguousarray(a, dtype=np.uint64) for a in (src, dst, new_cap))
+        _update_capacities(self.__graph_idx, self.__mode, src.ctypes.data, dst.ctypes.data, new_cap.ctypes.data, src.size)
+
+    def save(self, path):
+        # Writes the loaded graph to path as a binary snapshot, which Solver.open maps back without rebuilding it.
+        if not self.isLoaded:
+            raise ValueError("Load a graph first using load_graph or load_dimacs")
+        if self.__order is not None:
+            raise ValueError("graphs loaded with reorder cannot be saved, load them without reorder")
+        _save_graph(self.__graph_idx, self.__mode, os.fsencode(path))
+
+    def open(self, path):
+        # Maps a snapshot written by Solver.save. Solving works on a copy-on-write mapping and never modifies the file.
+        if self.isLoaded:
+            self.destroy_graphs()
+
+        self.__set_snapshot(_open_graph(os.fsencode(path)))
+
+    def __set_snapshot(self, info):
+        mode, self.n, m, self.__graph_idx = info
+        self.__mode = mode
+        self.isLoaded = True
+
+    def __getstate__(self):
+        # A loaded graph is pickled as its snapshot, together with its vertex order if it was reordered.
+        snapshot = _dump_graph(self.__graph_idx, self.__mode) if self.isLoaded else None
+        return {'snapshot': snapshot, 'order': self.__order}
+
+    def __setstate__(self, state):
+        self.__init__()
+        if state['snapshot'] is not None:
+            self.__set_snapshot(_load_graph_snapshot(state['snapshot']))
+            if state.get('order') is not None:
+                self.__set_order(state['order'])
+
+    def solve(self, alg, source, sink, nthreads=1, return_cut=False, cut_edges=False, return_flow=False):
+        # return_cut returns (flow, mask) instead of the flow, mask[v] is True for the vertices on the source side of a
+        # minimum cut. cut_edges returns (flow, mask, edges), edges being the k x 2 array of the arcs from the source side
+        # to the sink side. The arrays wrap buffers filled by the solver without copying them. return_flow, for graphs
+        # loaded with flow_index, inserts the flow on every entry of A as a sparse matrix with the pattern of A after
+        # the flow value. Push-relabel algorithms then also turn their maximum preflow into a flow.
+        if alg not in _alg_params:
+            raise ValueError("alg must be any one of : [{}]".format(', '.join(_alg_params)))
 
-    def solve(self, alg, source, sink, nthreads=1):
-        if (alg != self.alg) or (not self.isLoaded):
-            raise ValueError("Run load_graph method first using alg as a parameter first")
+        if not self.isLoaded:
+            raise ValueError("Load a graph first using load_graph, load_dimacs or open")
 
         if (type(source) != int) or (not (0 <= source < self.n)):
             raise ValueError("source must be a non-negative integer smaller than number of vertices")
@@ -83,14 +276,66 @@ class Solver:
         if source == sink:
             raise ValueError("source and sink must be different vertices")
 
-        args = [self.__mode, 0, 0, source, sink, self.__graph_idx] if (self.__func_idx == 1) else [self.__mode, 0, 0, 0, 0, 0, source, sink, self.__graph_idx]
+        if self.__rank is not None:
+            source, sink = int(self.__rank[source]), int(self.__rank[sink])
+
+        # A stored graph is passed by its index, the sparse loader arguments are unused.
+        args = [self.__mode, 0, 0, 0, 0, 0, source, sink, self.__graph_idx]
         param = _alg_params[alg]
-        if param[3]:
+        if param[4]:
             args.append(nthreads)
         
-        flow_value = param[self.__func_idx](*args)[0]
-        self.destroy_graphs()
-        return flow_value
+        if not return_flow:
+            flow = param[2](*args)[0]
+            result = (flow,)
+        else:
+            if self.__flow_pattern is None:
+                raise ValueError("return_flow needs a graph loaded with flow_index=True")
+            matrix_type, indices, indptr, shape, dtype = self.__flow_pattern
+            flows = np.empty(indices.size, dtype=np.uint64 if self.__mode in (2, 4) else np.uint32)
+            flow = param[7](self.__mode, self.__graph_idx, source, sink, flows.ctypes.data, nthreads)
+            result = (flow, matrix_type((flows.astype(dtype, copy=False), indices, indptr), shape=shape))
+
+        if return_cut or cut_edges:
+            mask, edges = _min_cut(self.__graph_idx, self.__mode, param[0], sink, cut_edges)
+            mask, edges = np.asarray(mask), np.asarray(edges)
+            if self.__order is not None:
+                # The arrays are renumbered into copies.
+                mask, edges = mask[self.__rank], self.__order[edges].astype(np.uint64)
+            result += (mask, edges) if cut_edges else (mask,)
+        return result if len(result) > 1 else flow
+
+    def solve_many(self, alg, sources, sinks, nthreads=1):
+        # Returns the flow values for the pairs sources[i], sinks[i] as a numpy array. Sequential algorithms solve the
+        # pairs concurrently on nthreads threads, each holding its own copy of the residual capacities, parallel ones
+        # solve them one after the other with nthreads threads.
+        if alg not in _alg_params:
+            raise ValueError("alg must be any one of : [{}]".format(', '.join(_alg_params)))
+
+        if not self.isLoaded:
+            raise ValueError("Load a graph first using load_graph, load_dimacs or open")
+
+        sources, sinks = np.asarray(sources), np.asarray(sinks)
+        if sources.ndim != 1 or sources.shape != sinks.shape:
+            raise ValueError("sources and sinks must be one dimensional and of the same length")
+
+        if sources.size > 0 and (not np.issubdtype(sources.dtype, np.integer) or not np.issubdtype(sinks.dtype, np.integer)):
+            raise ValueError("sources and sinks must be integers")
+
+        if np.any(sources < 0) or np.any(sources >= self.n) or np.any(sinks < 0) or np.any(sinks >= self.n):
+            raise ValueError("sources and sinks must be non-negative integers smaller than number of vertices")
+
+        if np.any(sources == sinks):
+            raise ValueError("source and sink must be different vertices")
+
+        if self.__rank is not None:
+            sources, sinks = self.__rank[sources], self.__rank[sinks]
+
+        sources = np.ascontiguousarray(sources, dtype=np.uint64)
+        sinks = np.ascontiguousarray(sinks, dtype=np.uint64)
+        flows = np.zeros(sources.size, dtype=np.uint64)
+        _alg_params[alg][5](self.__mode, self.__graph_idx, sources.ctypes.data, sinks.ctypes.data, sources.size, flows.ctypes.data, nthreads)
+        return flows
 
     def destroy_graphs(self):
         if self.__graph_idx is not None:
@@ -98,6 +343,9 @@ class Solver:
             assert num_delete == 1, "1 graph should be deleted!" 
             self.__graph_idx = None
             self.__mode = None
+            self.__flow_pattern = None
+            self.__order = None
+            self.__rank = None
         self.isLoaded = False
 
     def __del__(self):
@@ -106,8 +354,8 @@ class Solver:
 
 def get_mode(A):
     uint32_max = np.iinfo(np.uint32).max
-    if type(A) not in (np.ndarray, sparse.csr.csr_matrix):
-        raise TypeError("A must be either numpy.ndarray or scipy.sparse.csr.csr_matrix")
+    if not isinstance(A, np.ndarray) and type(A) not in (sparse.csr_matrix, sparse.csc_matrix):
+        raise TypeError("A must be either numpy.ndarray (numpy.memmap included), scipy.sparse.csr_matrix or scipy.sparse.csc_matrix")
 
     if A.shape[0] != A.shape[1]:
         raise ValueError("A.shape[0] != A.shape[1] : A must be square")
@@ -127,37 +375,90 @@ def get_mode(A):
             return 4
 
 
-def create_maxflow_runner(fn_dense, fn_sparse, isThreaded):
-
-    def maxflow_computer_sequential(A, source, sink):
+def gomory_hu(A, alg, nthreads=1):
+    # Gomory-Hu tree of the undirected network A, which must be symmetric, by Gusfield's algorithm using alg. The n - 1
+    # maximum flows are computed concurrently on nthreads threads. Returns the arrays parent and weight: the tree has the
+    # edge i - parent[i] of capacity weight[i] for every vertex i > 0, and parent[0] = -1. The maximum flow between two
+    # vertices is the smallest capacity on the tree path between them, and removing the edge i - parent[i] splits the
+    # vertices into a minimum cut of capacity weight[i].
+    if alg not in _alg_params:
+        raise ValueError("alg must be any one of : [{}]".format(', '.join(_alg_params)))
+
+    mode = get_mode(A)
+    symmetric = np.array_equal(A, A.T) if isinstance(A, np.ndarray) else (A != A.T).nnz == 0
+    if not symmetric:
+        raise ValueError("A must be symmetric")
+
+    func_idx, args, arrays = _graph_args(A, mode)
+    graph_idx = _store_fns[func_idx](*args, nthreads)
+    parent = np.empty(A.shape[0], dtype=np.int64)
+    weight = np.empty(A.shape[0], dtype=np.uint64)
+    try:
+        _alg_params[alg][6](mode, graph_idx, parent.ctypes.data, weight.ctypes.data, nthreads)
+    finally:
+        _destroy_graph(graph_idx)
+    return parent, weight
+
+
+def grid(capacities, terminal_caps, alg="push_relabel_highest", nthreads=1, return_cut=False):
+    # Maximum flow of a 2D or 3D lattice between a source and a sink joined to every pixel, without building its
+    # adjacency. capacities has shape (K, H, W), K being 4 or 8, or (K, D, H, W), K being 6 or 26: capacities[k] holds
+    # the capacities of the arcs from every pixel to its neighbour in direction k, the offsets in {-1, 0, 1}^2 (or ^3)
+    # of the neighbourhood in lexicographic (z, y, x) order, so that direction K - 1 - k is opposite to k. Arcs leaving
+    # the lattice are ignored. terminal_caps has shape (2, H, W), or (2, D, H, W), with the capacities from the source
+    # to every pixel and from every pixel to the sink. With return_cut, a boolean mask of the pixels on the source side
+    # of a minimum cut is returned along with the flow.
+    if alg not in _grid_algs:
+        raise ValueError("alg must be any one of : [{}]".format(', '.join(_grid_algs)))
+
+    capacities, terminal_caps = np.asarray(capacities), np.asarray(terminal_caps)
+    if capacities.ndim not in (3, 4) or capacities.shape[0] not in ((4, 8) if capacities.ndim == 3 else (6, 26)):
+        raise ValueError("capacities must have shape (K, H, W) with K in (4, 8) or (K, D, H, W) with K in (6, 26)")
+    shape = capacities.shape[1:]
+    if terminal_caps.shape != (2,) + shape:
+        raise ValueError("terminal_caps must have shape {}".format((2,) + shape))
+    if 0 in shape:
+        raise ValueError("The lattice must have at least one pixel")
+
+    nz, ny, nx = (1,) * (4 - capacities.ndim) + shape
+    wide = not np.result_type(capacities, terminal_caps) < np.int64
+    mode = (2 if wide else 1) if nx * ny * nz + 2 <= np.iinfo(np.uint32).max else (4 if wide else 3)
+    dtype = np.uint64 if wide else np.uint32
+    capacities = np.ascontiguousarray(capacities, dtype=dtype)
+    terminal_caps = np.ascontiguousarray(terminal_caps, dtype=dtype)
+    side = np.zeros(shape, dtype=np.uint8) if return_cut else None
+
+    flow = _grid_algs[alg](mode, capacities.ctypes.data, terminal_caps.ctypes.data, nx, ny, nz, capacities.shape[0],
+                           side.ctypes.data if return_cut else 0, nthreads)
+    if return_cut:
+        return flow, side.view(bool)
+    return flow
+
+
+def create_maxflow_runner(name, fn_dense, fn_sparse, fn_csr, isThreaded):
+    fns = {1: fn_dense, 2: fn_sparse, 3: fn_csr}
+
+    def solve_stored(A, source, sink, nthreads, **options):
+        # Cuts and flows are read from the residual network of a stored graph, which is destroyed with the solver.
+        solver = Solver()
+        solver.load_graph(A, nthreads=nthreads, flow_index=options['return_flow'])
+        return solver.solve(name, int(source), int(sink), nthreads, **options)
+
+    def maxflow_computer_sequential(A, source, sink, return_cut=False, cut_edges=False, return_flow=False):
+        if return_cut or cut_edges or return_flow:
+            return solve_stored(A, source, sink, 1, return_cut=return_cut, cut_edges=cut_edges, return_flow=return_flow)
         mode = get_mode(A)
+        func_idx, params, arrays = _graph_args(A, mode)
+        params += [source, sink, -1]
+        return fns[func_idx](*params)[0]
 
-        if type(A) is sparse.csr.csr_matrix:
-            A_coo = A.tocoo(copy=False)
-            n,m = A_coo.shape[0], A_coo.nnz
-            params = [mode, A_coo.data.ctypes.data, A_coo.row.ctypes.data, A_coo.col.ctypes.data, n, m, source, sink, -1]
-            return fn_sparse(*params)[0]
-
-        elif type(A) is np.ndarray:
-            np.ascontiguousarray(A)
-            n = A.shape[0]
-            params = [mode, A.ctypes.data, n, source, sink, -1]
-            return fn_dense(*params)[0]
-
-    def maxflow_computer_parallel(A, source, sink, nthreads=1):
+    def maxflow_computer_parallel(A, source, sink, nthreads=1, return_cut=False, cut_edges=False, return_flow=False):
+        if return_cut or cut_edges or return_flow:
+            return solve_stored(A, source, sink, nthreads, return_cut=return_cut, cut_edges=cut_edges, return_flow=return_flow)
         mode = get_mode(A)
-
-        if type(A) is sparse.csr.csr_matrix:
-            A_coo = A.tocoo(copy=False)
-            n,m = A_coo.shape[0], A_coo.nnz
-            params = [mode, A_coo.data.ctypes.data, A_coo.row.ctypes.data, A_coo.col.ctypes.data, n, m, source, sink, -1, nthreads]
-            return fn_sparse(*params)[0]
-
-        elif type(A) is np.ndarray:
-            np.ascontiguousarray(A)
-            n = A.shape[0]
-            params = [mode, A.ctypes.data, n, source, sink, -1, nthreads]
-            return fn_dense(*params)[0]
+        func_idx, params, arrays = _graph_args(A, mode)
+        params += [source, sink, -1, nthreads]
+        return fns[func_idx](*params)[0]
 
     if isThreaded:
         return maxflow_computer_parallel
@@ -166,6 +467,5 @@ def create_maxflow_runner(fn_dense, fn_sparse, isThreaded):
 
 
 for name, alg in _alg_params.items():
-    cmd = "{} = create_maxflow_runner({}, {}, {})".format(name, alg[1].__name__, alg[2].__name__, alg[3]) 
+    cmd = "{} = create_maxflow_runner('{}', {}, {}, {}, {})".format(name, name, alg[1].__name__, alg[2].__name__, alg[3].__name__, alg[4]) 
     exec(cmd)
-
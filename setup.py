@@ -7,10 +7,18 @@ import Cython.Compiler.Options
 Cython.Compiler.Options.annotate = True
 cwd = os.getcwd()
 
+# MAXFLOW_SOA_ARCS=1 stores the arcs as a structure of arrays instead of an array of structs.
+define_macros = [('MAXFLOW_SOA_ARCS', None)] if os.environ.get('MAXFLOW_SOA_ARCS', '0') != '0' else []
+# MAXFLOW_PREFETCH_DISTANCE=k prefetches the vertices k places ahead in the queues of the push-relabel instances, 0 (the
+# default) disables it.
+if 'MAXFLOW_PREFETCH_DISTANCE' in os.environ:
+    define_macros.append(('MAXFLOW_PREFETCH_DISTANCE', str(int(os.environ['MAXFLOW_PREFETCH_DISTANCE']))))
+
 cython_module = cythonize(Extension(
                            "maxflow._maxflow",                                
                            sources=[os.path.join(cwd, 'maxflow', '_maxflow.pyx')], 
                            language="c++",                        
+                           define_macros=define_macros,
                            extra_compile_args = ["-O3", "-std=c++17", "-fopenmp", "-w"],
                            extra_link_args = ["-fopenmp"],
                            ),
@@ -7,152 +7,512 @@
 #include <iostream>
 #include <vector>
 #include <memory>
-#include <unordered_map>
+#include <cstring>
 #include <cassert>
+#include <limits>
 #include "lib/common_types.h"
+#include "lib/data_structures/csr.h"
+#include "lib/data_structures/soa_csr.h"
+#include "lib/data_structures/grid.h"
+#include "lib/algorithms/parallel/prefix_sum.h"
+#include "lib/algorithms/parallel/bucket_partition.h"
+#include "lib/nonzero_mask.h"
 #include <queue>
 #include <algorithm>
 #include <vector>
 #include <type_traits>
+#include <typeindex>
+#include <functional>
+#include <omp.h>
 
 
-template <typename T, typename U, template <typename, typename> typename EDGE = basic_edge>
-void _init_graph(std::size_t num_edges, std::vector<T> &outgoing_edge_cnt, std::vector<EDGE<T, U>> &edges, std::vector<std::vector<EDGE<T, U>>> &graph)
+// Arc storage of the residual networks, a structure of arrays when built with MAXFLOW_SOA_ARCS.
+#ifndef DEFAULT_VECTOR
+#ifdef MAXFLOW_SOA_ARCS
+#define DEFAULT_VECTOR data_structures::soa_csr
+#else
+#define DEFAULT_VECTOR data_structures::csr
+#endif
+#endif
+
+template <typename T, typename U, template <typename, typename> typename EDGE>
+using residual_network = DEFAULT_VECTOR<DEFAULT_VECTOR<EDGE<T, U>>>;
+
+// Tag passing an edge template to generic lambdas, decltype(tag)::template type<T, U> is EDGE<T, U>.
+template <template <typename, typename> typename EDGE>
+struct edge_type
 {
-    //alloc graph
-    for (std::size_t i = 0; i < graph.size(); ++i) 
-    {
-        graph[i].reserve(outgoing_edge_cnt[i]);
+    template <typename T, typename U>
+    using type = EDGE<T, U>;
+};
+
+
+// An arc src -> dst together with its reverse arc. The pair is owned by src, which is the lower endpoint unless
+// stated otherwise.
+template <typename T, typename U>
+struct arc_pair
+{
+    T src;
+    T dst;
+    U cap;          // capacity of src -> dst
+    U reverse_cap;  // capacity of dst -> src
+};
+
+
+// Position of the arc of an input entry on the diagonal, which has none.
+constexpr std::size_t no_arc = std::numeric_limits<std::size_t>::max();
+
+
+// Writes the arc src -> dst at position src_pos and its reverse arc dst -> src at position dst_pos.
+template <typename T, typename U, template <typename, typename> typename EDGE>
+inline void _set_arc_pair(residual_network<T, U, EDGE> &graph, std::size_t src_pos, std::size_t dst_pos, T src, T dst, U cap, U reverse_cap)
+{
+    graph.arc(src_pos) = EDGE<T, U> (dst, cap, dst_pos - graph.offset(dst));
+    graph.arc(dst_pos) = EDGE<T, U> (src, reverse_cap, src_pos - graph.offset(src));
+    // Set reverse_r_capacity for cached edges used in push-relabel methods.
+    if constexpr(std::is_same_v<EDGE<T,U>, cached_edge<T,U>>) {
+        graph.arc(src_pos).reverse_r_capacity = reverse_cap;
+        graph.arc(dst_pos).reverse_r_capacity = cap;
     }
+}
 
-    //insert forward edges
-    for (std::size_t i = 0; i < num_edges; i += 2)
-    {
-        auto &edge = edges[i];
-        auto &reverse_edge = edges[i + 1];
-        graph[reverse_edge.dst_vertex].emplace_back(edge.dst_vertex, edge.r_capacity, i + 1);
+
+// Builds the CSR residual network from arc pairs grouped by their owner src, src_cnt[v] is the number of pairs with
+// src == v. The arcs a vertex owns come first in its adjacency, in the order of pairs. The pairs are then partitioned
+// by dst, so that the remaining arcs are appended without atomics.
+template <typename T, typename U, template <typename, typename> typename EDGE>
+auto _init_graph(const arc_pair<T, U>* pairs, std::size_t num_pairs, std::unique_ptr<std::size_t[]> src_cnt, std::size_t n, std::size_t nthreads)
+{
+    const int threads = static_cast<int> (nthreads);
+    const auto shift = bucket_partition::bucket_shift(n);
+    const std::size_t bucket_cnt = ((n - 1) >> shift) + 1;
+
+    std::unique_ptr<std::size_t[]> by_dst (new std::size_t[num_pairs]);
+    auto dst_bucket = bucket_partition::partition(num_pairs, bucket_cnt, nthreads,
+                                                 [&](std::size_t i) { return pairs[i].dst >> shift; },
+                                                 [&](std::size_t i, std::size_t pos) { by_dst[pos] = i; });
+
+    auto degree = std::make_unique<std::size_t[]> (n + 1);
+    #pragma omp parallel for schedule(dynamic, 16) num_threads(threads)
+    for (std::size_t b = 0; b < bucket_cnt; ++b)
+        for (std::size_t i = dst_bucket[b]; i < dst_bucket[b + 1]; ++i)
+            ++degree[pairs[by_dst[i]].dst];
+
+    #pragma omp parallel for schedule(static) num_threads(threads)
+    for (std::size_t v = 0; v < n; ++v)
+        degree[v] += src_cnt[v];
+
+    prefix_sum::exclusive_scan(src_cnt.get(), n + 1, nthreads);
+    prefix_sum::exclusive_scan(degree.get(), n + 1, nthreads);
+
+    //cursor[v] is the next free position for an arc v -> src, after the arcs owned by v
+    std::unique_ptr<std::size_t[]> cursor (new std::size_t[n]);
+    #pragma omp parallel for schedule(static) num_threads(threads)
+    for (std::size_t v = 0; v < n; ++v)
+        cursor[v] = degree[v] + src_cnt[v + 1] - src_cnt[v];
+
+    auto graph_ptr = std::make_shared<residual_network<T, U, EDGE>> (std::move(degree), n);
+    auto &graph = *graph_ptr;
+
+    #pragma omp parallel for schedule(dynamic, 16) num_threads(threads)
+    for (std::size_t b = 0; b < bucket_cnt; ++b) {
+        for (std::size_t i = dst_bucket[b]; i < dst_bucket[b + 1]; ++i) {
+            const auto idx = by_dst[i];
+            const auto &pair = pairs[idx];
+            const auto src_pos = graph.offset(pair.src) + idx - src_cnt[pair.src];
+            _set_arc_pair<T, U, EDGE> (graph, src_pos, cursor[pair.dst]++, pair.src, pair.dst, pair.cap, pair.reverse_cap);
+        }
     }
+    return graph_ptr;
+}
+
 
-    auto sizes = std::make_unique<T[]> (graph.size());
-    for (std::size_t i = 0; i < graph.size(); ++i)
-        sizes[i] = graph[i].size();
+// Visits the upper triangle in tiles of width x width entries, calling row(i, mask, first, forward, reverse) for every
+// row i of every tile with bit k of mask set if forward[k] = A[i][first + k] or reverse[k] = A[first + k][i] is
+// non-zero, first + k > i. The mirror tile below the diagonal is transposed into a buffer first, so that both halves
+// are read along rows and the tile stays in the cache while the masks are computed with vector compares. The rows of
+// a tile row are only visited by the thread that owns it, in the order of the columns.
+template<typename U, typename row_fn>
+void _scan_dense_tiles(const U* capacity_array, std::size_t n, std::size_t nthreads, row_fn&& row) {
 
-    //insert backward edges
-    for (std::size_t i = 0; i < graph.size(); ++i)
+    constexpr std::size_t width = nonzero_mask::width;
+    const std::size_t tiles = (n + width - 1) / width;
+    const int threads = static_cast<int> (nthreads);
+
+    #pragma omp parallel num_threads(threads)
     {
-        for (std::size_t k = 0; k < sizes[i]; ++k)
-        {
-            auto &edge = graph[i][k];
-            auto reverse_edge = edges[edge.reverse_edge_index]; 
-            edge.reverse_edge_index = graph[edge.dst_vertex].size();
-            graph[edge.dst_vertex].emplace_back(i, reverse_edge.r_capacity, k);
+        std::unique_ptr<U[]> transposed (new U[width * width]);
+        #pragma omp for schedule(dynamic, 1)
+        for (std::size_t ti=0; ti<tiles; ++ti) {
+            const std::size_t row_first = ti * width, rows = std::min(width, n - row_first);
+            for (std::size_t tj=ti; tj<tiles; ++tj) {
+                const std::size_t col_first = tj * width, cols = std::min(width, n - col_first);
+                for (std::size_t j=0; j<cols; ++j) {
+                    const U* mirror_row = capacity_array + (col_first + j) * n + row_first;
+                    for (std::size_t i=0; i<rows; ++i)
+                        transposed[i * width + j] = mirror_row[i];
+                }
+                for (std::size_t i=0; i<rows; ++i) {
+                    const U* forward = capacity_array + (row_first + i) * n + col_first;
+                    const U* reverse = transposed.get() + i * width;
+                    auto mask = nonzero_mask::of(forward, reverse, cols);
+                    //on the diagonal tile, only the entries right of the diagonal
+                    if (ti == tj)
+                        mask &= ~((std::uint64_t(2) << i) - 1);
+                    if (mask != 0)
+                        row(row_first + i, mask, col_first, forward, reverse);
+                }
+            }
         }
     }
 }
 
 
-// Set reverse_r_capacity for cached edges used in push-relabel methods.
-template <typename T, typename U>
-void set_reverse_edge_cap(std::vector<std::vector<cached_edge<T, U>>> & graph)
-{
-    for (auto &vec : graph)
-        for (auto &edge : vec)
-            edge.reverse_r_capacity = graph[edge.dst_vertex][edge.reverse_edge_index].r_capacity;
+// Two passes over the upper triangle, the first one counts the arc pairs of every row and the second one writes them,
+// so the memory used is proportional to the number of non-zero entries. A pair {i, j}, i < j, exists if A[i][j] or
+// A[j][i] is non-zero.
+template<typename T, typename U, template <typename, typename> typename EDGE>
+auto _load_graph_dense(void* A_ptr, size_t n, size_t nthreads=1) {
+
+    const U* capacity_array = (U*) A_ptr;
+    auto src_cnt = std::make_unique<std::size_t[]> (n + 1);
+
+    _scan_dense_tiles(capacity_array, n, nthreads, [&](std::size_t i, std::uint64_t mask, std::size_t, const U*, const U*) {
+        src_cnt[i] += __builtin_popcountll(mask);
+    });
+
+    auto row_start = std::make_unique<std::size_t[]> (n + 1);
+    std::copy_n(src_cnt.get(), n + 1, row_start.get());
+    const auto num_pairs = prefix_sum::exclusive_scan(row_start.get(), n + 1, nthreads);
+    std::unique_ptr<arc_pair<T, U>[]> pairs (new arc_pair<T, U>[num_pairs]);
+
+    //row_start[i] moves along as the pairs of row i are written, the tiles of a row being visited left to right
+    _scan_dense_tiles(capacity_array, n, nthreads, [&](std::size_t i, std::uint64_t mask, std::size_t first, const U* forward, const U* reverse) {
+        auto &pos = row_start[i];
+        for (; mask != 0; mask &= mask - 1) {
+            const std::size_t k = __builtin_ctzll(mask);
+            pairs[pos++] = arc_pair<T, U> {static_cast<T> (i), static_cast<T> (first + k), forward[k], reverse[k]};
+        }
+    });
+
+    return _init_graph<T, U, EDGE> (pairs.get(), num_pairs, std::move(src_cnt), n, nthreads);
 }
 
 
+// COO entries are partitioned into buckets of consecutive lower endpoints and every bucket is sorted, so that entries
+// (u, v) and (v, u) as well as duplicates end up next to each other and are merged into a single pair of arcs.
 template<typename T, typename U, template <typename, typename> typename EDGE>
-auto _load_graph_dense(void* A_ptr, size_t n) {
-    
+auto _load_graph_sparse(void* A_ptr, void* row_ptr, void* col_ptr, size_t n, size_t m, size_t nthreads=1) {
+
     const U* capacity_array = (U*) A_ptr;
-    std::vector<EDGE<T,U>> edges;
-    std::vector<T> outgoing_edge_cnt(n);
-    std::size_t num_edges = 0;
-    edges.resize(n*n);
-
-    for (std::size_t i=0; i<n; ++i) {
-        for (std::size_t j=i+1; j<n; ++j) {
-            std::size_t forward_idx = i*n + j;
-            std::size_t reverse_idx = j*n + i;
-            if (capacity_array[forward_idx] != 0) {
-                edges[num_edges].dst_vertex = j;
-                edges[num_edges].r_capacity = capacity_array[forward_idx];
-                edges[num_edges+1].dst_vertex = i;
-                edges[num_edges+1].r_capacity = capacity_array[reverse_idx];
-                outgoing_edge_cnt[i] += 1;
-                outgoing_edge_cnt[j] += 1;
-                num_edges += 2;
+    const T* rows = (T*) row_ptr;
+    const T* cols = (T*) col_ptr;
+    const int threads = static_cast<int> (nthreads);
+    const auto shift = bucket_partition::bucket_shift(n);
+    const std::size_t bucket_cnt = ((n - 1) >> shift) + 1;
+
+    //self loops can never carry flow, they go to an extra bucket which is ignored
+    std::unique_ptr<arc_pair<T, U>[]> entries (new arc_pair<T, U>[m]);
+    auto bucket = bucket_partition::partition(m, bucket_cnt + 1, nthreads,
+        [&](std::size_t i) { return rows[i] == cols[i] ? bucket_cnt : std::min(rows[i], cols[i]) >> shift; },
+        [&](std::size_t i, std::size_t pos) {
+            if (rows[i] < cols[i])
+                entries[pos] = arc_pair<T, U> {rows[i], cols[i], capacity_array[i], 0};
+            else
+                entries[pos] = arc_pair<T, U> {cols[i], rows[i], 0, capacity_array[i]};
+        });
+
+    //merge each bucket in place, num_merged[b] is the number of pairs left in bucket b
+    auto src_cnt = std::make_unique<std::size_t[]> (n + 1);
+    auto num_merged = std::make_unique<std::size_t[]> (bucket_cnt + 1);
+    #pragma omp parallel for schedule(dynamic, 16) num_threads(threads)
+    for (std::size_t b = 0; b < bucket_cnt; ++b) {
+        auto * first = entries.get() + bucket[b], * last = entries.get() + bucket[b + 1];
+        if (first == last)
+            continue;
+        std::sort(first, last, [](const arc_pair<T, U> &x, const arc_pair<T, U> &y) {
+            return x.src < y.src || (x.src == y.src && x.dst < y.dst);
+        });
+        auto * out = first;
+        ++src_cnt[out->src];
+        for (auto * it = first + 1; it != last; ++it) {
+            if (it->src == out->src && it->dst == out->dst) {
+                out->cap += it->cap;
+                out->reverse_cap += it->reverse_cap;
+            } else {
+                *++out = *it;
+                ++src_cnt[out->src];
             }
-            else if (capacity_array[reverse_idx] != 0) {
-                edges[num_edges].dst_vertex = i;
-                edges[num_edges].r_capacity = capacity_array[reverse_idx];
-                edges[num_edges+1].dst_vertex = j;
-                edges[num_edges+1].r_capacity = 0;
-                outgoing_edge_cnt[i] += 1;
-                outgoing_edge_cnt[j] += 1;
-                num_edges += 2;
+        }
+        num_merged[b] = out - first + 1;
+    }
+
+    //compact the merged buckets
+    prefix_sum::exclusive_scan(num_merged.get(), bucket_cnt + 1, nthreads);
+    std::unique_ptr<arc_pair<T, U>[]> pairs (new arc_pair<T, U>[num_merged[bucket_cnt]]);
+    #pragma omp parallel for schedule(dynamic, 16) num_threads(threads)
+    for (std::size_t b = 0; b < bucket_cnt; ++b)
+        std::copy_n(entries.get() + bucket[b], num_merged[b + 1] - num_merged[b], pairs.get() + num_merged[b]);
+    entries.reset();
+
+    return _init_graph<T, U, EDGE> (pairs.get(), num_merged[bucket_cnt], std::move(src_cnt), n, nthreads);
+}
+
+
+// Reads a CSR matrix with sorted and unique column indices in place. A CSC matrix is the CSR matrix of its transpose,
+// in which case every stored entry (u, v) is the arc v -> u. Every pair {u, v} is owned by the row u in which it is
+// found first - row min(u, v) if it stores the entry, otherwise row max(u, v). The first pass looks up the mirror
+// entry of every entry below the diagonal by a binary search and records it, so the second pass reads the rows in
+// order and no sorting or merging is needed. If entry_arcs is given, entry_arcs[i] is set to the position of the arc
+// the i'th stored entry describes, or no_arc for entries on the diagonal.
+template<typename T, typename U, template <typename, typename> typename EDGE, typename I>
+auto _load_graph_csr(void* A_ptr, void* indptr_ptr, void* indices_ptr, size_t n, bool transposed, size_t nthreads=1, std::size_t* entry_arcs=nullptr) {
+
+    const U* capacity_array = (U*) A_ptr;
+    const I* indptr = (I*) indptr_ptr;
+    const I* indices = (I*) indices_ptr;
+    const std::size_t m = indptr[n];
+    const int threads = static_cast<int> (nthreads);
+
+    //for an entry (u, v), v > u, mirror[i] - 1 is the position of the entry (v, u), if any. For v < u, mirror[i] is
+    //non-zero if the entry (v, u) exists and the pair is owned by row v.
+    auto mirror = std::make_unique<I[]> (m);
+    auto src_cnt = std::make_unique<std::size_t[]> (n + 1);
+    #pragma omp parallel for schedule(dynamic, 64) num_threads(threads)
+    for (std::size_t u=0; u<n; ++u) {
+        std::size_t cnt = 0;
+        for (auto i=indptr[u]; i<indptr[u + 1]; ++i) {
+            const std::size_t v = indices[i];
+            if (v > u) {
+                ++cnt;
+            } else if (v < u) {
+                auto first = indices + indptr[v], last = indices + indptr[v + 1];
+                auto it = std::lower_bound(first, last, static_cast<I> (u));
+                if (it != last && static_cast<std::size_t> (*it) == u) {
+                    mirror[it - indices] = i + 1;
+                    mirror[i] = 1;
+                } else {
+                    ++cnt;
+                }
             }
         }
+        src_cnt[u] = cnt;
     }
 
-    edges.resize(num_edges);
-    auto graph_ptr = std::make_shared<std::vector<std::vector<EDGE<T, U>>>> (n);
-    _init_graph<T, U, EDGE> (num_edges, outgoing_edge_cnt, edges, *graph_ptr);
-    if constexpr(std::is_same_v<EDGE<T,U>, cached_edge<T,U>>) {
-        set_reverse_edge_cap<T, U>(*graph_ptr);
+    auto row_start = std::make_unique<std::size_t[]> (n + 1);
+    std::copy_n(src_cnt.get(), n + 1, row_start.get());
+    const auto num_pairs = prefix_sum::exclusive_scan(row_start.get(), n + 1, nthreads);
+    std::unique_ptr<arc_pair<T, U>[]> pairs (new arc_pair<T, U>[num_pairs]);
+
+    //until the network is built, entry_arcs holds the index of the pair of an entry, with the reverse flag set if the
+    //entry describes the arc dst -> src of the pair
+    constexpr std::size_t reverse = std::size_t(1) << (std::numeric_limits<std::size_t>::digits - 1);
+    #pragma omp parallel for schedule(dynamic, 64) num_threads(threads)
+    for (std::size_t u=0; u<n; ++u) {
+        auto pos = row_start[u];
+        for (auto i=indptr[u]; i<indptr[u + 1]; ++i) {
+            const std::size_t v = indices[i];
+            if (v == u && entry_arcs)
+                entry_arcs[i] = no_arc;
+            if (v == u || (v < u && mirror[i] != 0))
+                continue;
+            U stored = capacity_array[i], other_stored = v > u && mirror[i] != 0 ? capacity_array[mirror[i] - 1] : 0;
+            if (transposed)
+                std::swap(stored, other_stored);
+            if (entry_arcs) {
+                entry_arcs[i] = transposed ? pos | reverse : pos;
+                if (v > u && mirror[i] != 0)
+                    entry_arcs[mirror[i] - 1] = transposed ? pos : pos | reverse;
+            }
+            pairs[pos++] = arc_pair<T, U> {static_cast<T> (u), static_cast<T> (v), stored, other_stored};
+        }
+    }
+    mirror.reset();
+
+    auto graph_ptr = _init_graph<T, U, EDGE> (pairs.get(), num_pairs, std::move(src_cnt), n, nthreads);
+    if (entry_arcs) {
+        auto &graph = *graph_ptr;
+        #pragma omp parallel for schedule(static) num_threads(threads)
+        for (std::size_t i=0; i<m; ++i) {
+            if (entry_arcs[i] == no_arc)
+                continue;
+            const auto idx = entry_arcs[i] & ~reverse;
+            const auto &pair = pairs[idx];
+            const auto src_pos = graph.offset(pair.src) + idx - row_start[pair.src];
+            entry_arcs[i] = entry_arcs[i] & reverse ? graph.offset(pair.dst) + graph.arc(src_pos).reverse_edge_index : src_pos;
+        }
     }
     return graph_ptr;
 }
 
 
+// Builds the implicit network of a lattice of nz x ny x nx pixels, see data_structures::grid. capacities holds one
+// array of pixels per direction, capacities[k * pixels + p] being the capacity from pixel p to its neighbour in
+// direction k, and terminals the capacities from the source to every pixel followed by those from every pixel to the
+// sink. The capacities of the arcs which leave the lattice are ignored.
+template<typename T, typename U, template <typename, typename> typename EDGE>
+auto _load_graph_grid(const U* capacities, const U* terminals, size_t nx, size_t ny, size_t nz, size_t neighbours, size_t nthreads=1) {
+    using network = data_structures::grid<data_structures::grid<EDGE<T, U>>>;
+    auto graph_ptr = std::make_unique<network>(nx, ny, nz, neighbours);
+    const auto& shape = graph_ptr->shape();
+    const std::size_t pixels = shape.pixel_cnt, rows = ny * nz;
+    const int threads = static_cast<int> (nthreads);
+    // whether coordinate c, of a lattice of n along its axis, has a neighbour at offset d in {-1, 0, 1}
+    auto within = [](std::size_t c, int d, std::size_t n) { return d < 0 ? c > 0 : d == 0 || c + 1 < n; };
+    #pragma omp parallel for schedule(static) num_threads(threads)
+    for (std::size_t row = 0; row < rows; ++row) {
+        const std::size_t y = row % ny, z = row / ny, first = row * nx;
+        for (std::size_t k = 0; k < neighbours; ++k) {
+            const auto& offset = shape.offsets[k];
+            U* dst = shape.direction(k) + first;
+            const U* src = capacities + k * pixels + first;
+            // the pixels of the row whose neighbour in direction k is on the lattice are [lo, hi)
+            const std::size_t lo = offset[2] < 0 ? 1 : 0, hi = offset[2] > 0 ? nx - 1 : nx;
+            if (within(z, offset[0], nz) && within(y, offset[1], ny) && lo < hi) {
+                std::copy(src + lo, src + hi, dst + lo);
+                std::fill(dst, dst + lo, 0);
+                std::fill(dst + hi, dst + nx, 0);
+            } else {
+                std::fill_n(dst, nx, 0);
+            }
+        }
+        std::copy_n(terminals + first, nx, shape.from_source() + first);
+        std::copy_n(terminals + pixels + first, nx, shape.to_sink() + first);
+        std::fill_n(shape.to_source() + first, nx, 0);
+        std::fill_n(shape.from_sink() + first, nx, 0);
+    }
+    return graph_ptr;
+}
+
 
+// Builds the network an algorithm with edge type EDGE solves on from a stored network of cached edges. The offsets
+// are shared and the arcs are copied, so solving leaves the stored capacities intact.
 template<typename T, typename U, template <typename, typename> typename EDGE>
-auto _load_graph_sparse(void* A_ptr, void* row_ptr, void* col_ptr, size_t n, size_t m) {
-    
-    const U* capacity_array = (U*) A_ptr;
-    const T* rows = (T*) row_ptr;
-    const T* cols = (T*) col_ptr;
-    std::vector<EDGE<T,U>> edges;
-    std::vector<T> outgoing_edge_cnt(n);
-    std::vector<std::unordered_map<T, T>> edge_map(n);
-    size_t num_edges = 0;
-    T src, dst;
-    U cap;
-    auto undefined = std::numeric_limits<T>::max ();
-
-    if ((2*m) > (n*n)) {
-        edges.reserve(n*n);
+auto _solve_network(const residual_network<T, U, cached_edge>& stored, size_t nthreads=1) {
+    auto graph_ptr = std::make_shared<residual_network<T, U, EDGE>> (stored.shared_offsets(), stored.size());
+    auto &graph = *graph_ptr;
+    const std::size_t m = stored.arc_count();
+    const int threads = static_cast<int> (nthreads);
+
+    #pragma omp parallel for schedule(static) num_threads(threads)
+    for (std::size_t i=0; i<m; ++i) {
+        auto && arc = stored.arc(i);
+        graph.arc(i) = EDGE<T, U> (arc.dst_vertex, arc.r_capacity, arc.reverse_edge_index);
+        if constexpr(std::is_same_v<EDGE<T,U>, cached_edge<T,U>>)
+            graph.arc(i).reverse_r_capacity = arc.reverse_r_capacity;
     }
-    else {
-        edges.reserve(2*m);
+    return graph_ptr;
+}
+
+
+// Resets a network built by _solve_network to the capacities of the stored network. Solving changes capacities only,
+// so a network of cached edges is reset by copying the arc storage in chunks and one of basic edges by copying
+// r_capacity.
+template<typename T, typename U, template <typename, typename> typename EDGE>
+void _reset_network(residual_network<T, U, EDGE>& graph, const residual_network<T, U, cached_edge>& stored, size_t nthreads=1) {
+    const int threads = static_cast<int> (nthreads);
+    if constexpr(std::is_same_v<EDGE<T,U>, cached_edge<T,U>>) {
+        constexpr std::size_t chunk = 1 << 20;
+        const std::size_t bytes = stored.storage_bytes(stored.arc_count());
+        const std::size_t chunk_cnt = (bytes + chunk - 1) / chunk;
+        auto* dst = static_cast<char*> (graph.storage());
+        const auto* src = static_cast<const char*> (stored.storage());
+        #pragma omp parallel for schedule(static) num_threads(threads)
+        for (std::size_t c=0; c<chunk_cnt; ++c)
+            std::memcpy(dst + c * chunk, src + c * chunk, std::min(chunk, bytes - c * chunk));
+    } else {
+        const std::size_t m = stored.arc_count();
+        #pragma omp parallel for schedule(static) num_threads(threads)
+        for (std::size_t i=0; i<m; ++i)
+            graph.arc(i).r_capacity = stored.arc(i).r_capacity;
     }
+}
 
-    for (size_t i=0; i<m; ++i) {
-        cap = capacity_array[i];
-        src = rows[i];
-        dst = cols[i];
-        auto it = edge_map[dst].find(src);
-        if (it != std::end(edge_map[dst])){
-            edges[it->second+1].r_capacity += cap;
-        }
-        else {
-            edges.emplace_back(dst, cap, undefined);
-            edges.emplace_back(src, 0, undefined);
-            edge_map[src].emplace(dst, num_edges);
-            outgoing_edge_cnt[src] += 1;
-            outgoing_edge_cnt[dst] += 1;
-            num_edges += 2;
+
+// Renumbers the vertices of a network, order[i] is the vertex numbered i in the new network and rank its inverse. Every
+// vertex keeps its arcs in their order, so the reverse indices stay valid and the arc at index k of vertex v moves to
+// index k of vertex rank[v]. entry_arcs, if given, holds entry_cnt arc positions which are moved along.
+template<typename T, typename U, template <typename, typename> typename EDGE>
+auto _permute_graph(const residual_network<T, U, EDGE>& graph, const T* order, const T* rank, size_t nthreads, std::size_t* entry_arcs=nullptr, std::size_t entry_cnt=0) {
+    const std::size_t n = graph.size();
+    const int threads = static_cast<int> (nthreads);
+    auto offsets = std::make_unique<std::size_t[]> (n + 1);
+    #pragma omp parallel for schedule(static) num_threads(threads)
+    for (std::size_t v = 0; v < n; ++v)
+        offsets[v] = graph.offset(order[v] + 1) - graph.offset(order[v]);
+    prefix_sum::exclusive_scan(offsets.get(), n + 1, nthreads);
+
+    auto graph_ptr = std::make_shared<residual_network<T, U, EDGE>> (std::move(offsets), n);
+    auto &permuted = *graph_ptr;
+    #pragma omp parallel for schedule(dynamic, 64) num_threads(threads)
+    for (std::size_t v = 0; v < n; ++v) {
+        auto pos = permuted.offset(v);
+        for (auto arc = graph.offset(order[v]); arc < graph.offset(order[v] + 1); ++arc, ++pos) {
+            auto && edge = graph.arc(arc);
+            permuted.arc(pos) = EDGE<T, U> (rank[edge.dst_vertex], edge.r_capacity, edge.reverse_edge_index);
+            if constexpr(std::is_same_v<EDGE<T,U>, cached_edge<T,U>>)
+                permuted.arc(pos).reverse_r_capacity = edge.reverse_r_capacity;
         }
     }
 
-    edges.shrink_to_fit();
-    auto graph_ptr = std::make_shared<std::vector<std::vector<EDGE<T, U>>>> (n);
-    _init_graph<T, U, EDGE> (num_edges, outgoing_edge_cnt, edges, *graph_ptr);
-    if constexpr(std::is_same_v<EDGE<T,U>, cached_edge<T,U>>) {
-        set_reverse_edge_cap<T, U>(*graph_ptr);
+    //the owner of an arc is found by a binary search over the offsets
+    const std::size_t* old_offsets = graph.offsets();
+    #pragma omp parallel for schedule(static) num_threads(threads)
+    for (std::size_t i = 0; i < entry_cnt; ++i) {
+        if (entry_arcs[i] == no_arc)
+            continue;
+        const std::size_t vertex = std::upper_bound(old_offsets, old_offsets + n + 1, entry_arcs[i]) - old_offsets - 1;
+        entry_arcs[i] = permuted.offset(rank[vertex]) + entry_arcs[i] - old_offsets[vertex];
     }
     return graph_ptr;
 }
 
+
+// A saved graph: the network with the original capacities and, per edge type, the network the last run solved on,
+// which the next run resets instead of building it again.
+template <typename T, typename U>
+struct stored_graph
+{
+    using network_type = residual_network<T, U, cached_edge>;
+
+    // The instance which solved cached_residual last, if it can resume after capacity updates.
+    struct resumable_instance
+    {
+        std::type_index alg;
+        T source;
+        T sink;
+        std::function<void (T, std::size_t, U, U)> update_capacity;  // vertex, arc position, capacity, new capacity
+        std::function<U ()> resume;
+        std::function<void ()> preflow_to_flow;
+    };
+
+    std::shared_ptr<network_type> network;
+    std::shared_ptr<residual_network<T, U, cached_edge>> cached_residual;
+    std::shared_ptr<residual_network<T, U, basic_edge>> basic_residual;
+    std::unique_ptr<resumable_instance> instance;
+    // For graphs loaded from a CSR matrix with an entry index, the position of the arc of every stored entry, or
+    // no_arc for the entries on the diagonal.
+    std::shared_ptr<std::size_t[]> entry_arcs;
+    std::size_t entry_cnt = 0;
+
+    // Returns the network with edge type EDGE to solve on, with the original capacities.
+    template <template <typename, typename> typename EDGE>
+    std::shared_ptr<residual_network<T, U, EDGE>> residual(size_t nthreads) {
+        auto &graph = [&]() -> auto& {
+            if constexpr(std::is_same_v<EDGE<T,U>, cached_edge<T,U>>) {
+                instance.reset();
+                return cached_residual;
+            } else {
+                return basic_residual;
+            }
+        }();
+        if (graph)
+            _reset_network<T, U, EDGE>(*graph, *network, nthreads);
+        else
+            graph = _solve_network<T, U, EDGE>(*network, nthreads);
+        return graph;
+    }
+};
+
     
 #endif //MAXFLOW_GRAPH_LOADER_H
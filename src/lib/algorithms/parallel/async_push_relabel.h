@@ -0,0 +1,338 @@
+/*
+ * Asynchronous parallel push-relabel, after the lock-free algorithm of
+ * Hong, Bo and He, Zhengyu, An Asynchronous Multithreaded Algorithm for the Maximum Network Flow Problem with
+ * Nonblocking Global Relabeling Heuristic, IEEE TPDS, 2011,
+ * and the synchronization free variant in
+ * Baumstark, Niklas, Speeding up Maximum Flow Computations on Shared-Memory Platforms, KIT, Karlsruhe, 2014.
+ *
+ * The threads discharge vertices on their own, without phases or barriers. A vertex is discharged by the thread which
+ * claimed it with the flag of its record, so its label and the residual capacities of its arcs only ever decrease
+ * under that thread, while the other threads add to its excess and to the capacities of its arcs with atomic
+ * operations. A push goes down any residual arc to a lower label, a relabel moves the vertex one above its lowest
+ * residual neighbour and only happens when that is above its label, as labels read from other threads may be stale.
+ * Vertices which get excess are claimed by the thread which pushed and discharged in FIFO order from a queue of its
+ * own, which hands its newest vertices to the other threads in chunks once it grows. Taking the newest vertex first
+ * instead sends the excess back and forth between neighbours, with several times the pushes and relabels.
+ *
+ * Once the relabels have done enough work the threads stop after the vertex at hand, and the labels are set to the
+ * exact distances by a parallel breadth first search before they go on. A search with the threads stopped is exact,
+ * which the termination relies on: the threads are done once no vertex they can reach the sink from is left with
+ * excess, which a search then confirms.
+ */
+
+#ifndef MAXFLOW_ASYNC_PUSH_RELABEL_H
+#define MAXFLOW_ASYNC_PUSH_RELABEL_H
+
+#include <memory>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <iostream>
+#include <omp.h>
+#include <algorithm>
+#include "../../common_types.h"
+#include "../../min_label.h"
+#include "../sequential/preflow_conversion.h"
+#include "parallel_bfs.h"
+
+#ifndef CACHE_LINE_SIZE
+#define CACHE_LINE_SIZE 64
+#endif
+
+namespace async_push_relabel
+{
+    template <template <class> typename vector, typename T, typename U>
+    class max_flow_instance
+    {
+        struct alignas (CACHE_LINE_SIZE) vertex
+        {
+            U excess { 0 };
+            T label;
+            std::atomic_flag claimed = ATOMIC_FLAG_INIT;
+        };
+
+        //the vertices a thread claimed and has yet to discharge, and its share of the statistics
+        struct alignas (CACHE_LINE_SIZE) worker
+        {
+            std::deque<T> queue;
+            std::size_t relabel_progress { 0 };
+            uint64_t push_cnt { 0 }, relabel_cnt { 0 };
+        };
+
+        vector<vector<cached_edge<T, U>>> & _residual_network;
+        std::unique_ptr<vertex[]> _vertices;
+        std::unique_ptr<worker[]> _workers;
+        std::vector<std::vector<T>> _chunks;
+        std::mutex _chunks_lock;
+        parallel_bfs::levels<T> _levels;
+        std::atomic<std::size_t> _chunk_cnt { 0 }, _claimed_cnt { 0 }, _relabel_progress { 0 };
+        std::atomic<bool> _stop { false };
+        T _source, _sink;
+        std::size_t _relabel_threshold;
+        const std::size_t _thread_count;
+
+        //statistics
+        uint64_t _epoch_cnt { 0 }, _global_update_cnt { 0 };
+    public:
+        max_flow_instance ( vector<vector<cached_edge<T, U>>> & graph, T source, T sink,
+                            std::size_t thread_count = static_cast<size_t>(omp_get_max_threads ()) )
+                :
+                _residual_network ( graph ),
+                _vertices ( std::make_unique<vertex[]> ( _residual_network . size () ) ),
+                _workers ( std::make_unique<worker[]> ( thread_count ) ),
+                _levels ( _residual_network . size (), thread_count ),
+                _source ( source ), _sink ( sink ), _thread_count ( thread_count )
+        {
+            init ();
+        }
+
+        U find_max_flow ( )
+        {
+            find_max_flow_inner ();
+
+            #ifdef DEBUG
+            uint64_t push_cnt = 0, relabel_cnt = 0;
+            for ( std::size_t i = 0; i < _thread_count; ++i )
+            {
+                push_cnt += _workers[i] . push_cnt;
+                relabel_cnt += _workers[i] . relabel_cnt;
+            }
+            std::cout << "pushes:\t\t" << push_cnt << std::endl;
+            std::cout << "relabels:\t" << relabel_cnt << std::endl;
+            std::cout << "global updates:\t" << _global_update_cnt << std::endl;
+            std::cout << "bfs steps:\t" << _levels . steps () << " (" << _levels . bottom_up_steps () << " bottom-up)" << std::endl;
+            std::cout << "epochs:\t\t" << _epoch_cnt << std::endl;
+            #endif
+            return _vertices[_sink] . excess;
+        }
+
+        //returns the excess left by find_max_flow to the source, capacity_of ( arc ) is the capacity of the arc with
+        //index arc, see preflow_conversion
+        template <typename capacity_fn>
+        void preflow_to_flow ( capacity_fn && capacity_of )
+        {
+            preflow_conversion::preflow_to_flow ( _residual_network, _source, _sink,
+                                                  [this] ( T v ) -> U & { return _vertices[v] . excess; }, capacity_of );
+            #ifdef DEBUG
+            for ( std::size_t i = 0; i < _residual_network . size(); ++i )
+                if ( i != _source && i != _sink )
+                    if ( _vertices[i] . excess > 0 )
+                        std::cerr << "Excess violation: vertex " << i << ", excess " << _vertices[i] . excess << '\n';
+            #endif
+        }
+
+        auto steal_network ( )
+        {
+            return std::move ( _residual_network );
+        }
+
+    private:
+        static constexpr T ALPHA = 6, BETA = 12;
+        static constexpr double GLOBAL_RELABEL_FREQ = 0.5;
+        //vertices handed to the other threads at once, and the relabel work a thread adds up before it publishes it
+        static constexpr std::size_t CHUNK = 64, PROGRESS_BATCH = 4096;
+
+        void init ( ) noexcept
+        {
+            for ( auto && edge : _residual_network[_source] )
+            {
+                _vertices[edge . dst_vertex] . excess += edge . r_capacity;
+                edge . reverse_r_capacity += edge . r_capacity;
+                _residual_network[edge . dst_vertex][edge . reverse_edge_index] . r_capacity += edge . r_capacity;
+                _residual_network[edge . dst_vertex][edge . reverse_edge_index] . reverse_r_capacity -= edge . r_capacity;
+                edge . r_capacity = 0;
+            }
+
+            std::size_t m = 0;
+            for ( std::size_t i = 0; i < _residual_network . size (); ++i )
+                m += _residual_network[i] . size ();
+            _relabel_threshold = _residual_network . size () * ALPHA + m / 2;
+        }
+
+        void find_max_flow_inner ( )
+        {
+            global_relabel ();
+            while ( _claimed_cnt . load ( std::memory_order_relaxed ) > 0 )
+            {
+                ++_epoch_cnt;
+                _stop . store ( false, std::memory_order_relaxed );
+                _relabel_progress . store ( 0, std::memory_order_relaxed );
+
+                #pragma omp parallel num_threads(static_cast<int> ( _thread_count ))
+                run ( _workers[omp_get_thread_num ()] );
+
+                global_relabel ();
+            }
+        }
+
+        //the loop of every thread, which returns once no vertex is claimed or a global relabel is due
+        void run ( worker & self ) noexcept
+        {
+            for ( ;; )
+            {
+                if ( _stop . load ( std::memory_order_relaxed ) )
+                    return;
+                if ( self . queue . empty () && !take_chunk ( self . queue ) )
+                {
+                    if ( _claimed_cnt . load ( std::memory_order_acquire ) == 0 )
+                        return;
+                    std::this_thread::yield ();
+                    continue;
+                }
+
+                const T vertex = self . queue . front ();
+                self . queue . pop_front ();
+                discharge ( vertex, self );
+                if ( self . queue . size () >= 2 * CHUNK && _thread_count > 1 )
+                    give_chunk ( self . queue );
+            }
+        }
+
+        void discharge ( const T vertex, worker & self ) noexcept
+        {
+            const auto n = static_cast<T> ( _residual_network . size () );
+            auto & record = _vertices[vertex];
+            for ( ;; )
+            {
+                const T label = record . label;
+                if ( push ( vertex, label, self ) )
+                {
+                    //the excess is gone, unless a push arrived before the vertex is released
+                    record . claimed . clear ();
+                    if ( __atomic_load_n ( &record . excess, __ATOMIC_SEQ_CST ) > 0 && !record . claimed . test_and_set () )
+                        continue;
+                    _claimed_cnt . fetch_sub ( 1, std::memory_order_release );
+                    return;
+                }
+
+                const T new_label = min_label::over_residual_arcs ( _residual_network[vertex], _vertices . get (),
+                                                                    &max_flow_instance::vertex::label,
+                                                                    static_cast<T> ( n - 1 ) ) + 1;
+                add_relabel_progress ( self, BETA + _residual_network[vertex] . size () );
+                //a residual arc to a lower label appeared after the push, which pushes along it next time
+                if ( new_label <= label )
+                    continue;
+                ++self . relabel_cnt;
+                __atomic_store_n ( &record . label, new_label, __ATOMIC_RELAXED );
+                if ( new_label >= n )
+                {
+                    record . claimed . clear ();
+                    _claimed_cnt . fetch_sub ( 1, std::memory_order_release );
+                    return;
+                }
+                if ( _stop . load ( std::memory_order_relaxed ) )
+                {
+                    self . queue . push_back ( vertex );
+                    return;
+                }
+            }
+        }
+
+        //pushes along the residual arcs to lower labels, returns true once the excess of vertex is gone
+        bool push ( const T vertex, const T label, worker & self ) noexcept
+        {
+            auto & record = _vertices[vertex];
+            U excess = __atomic_load_n ( &record . excess, __ATOMIC_ACQUIRE );
+            if ( excess == 0 )
+                return true;
+            for ( auto && edge : _residual_network[vertex] )
+            {
+                const U r_capacity = __atomic_load_n ( &edge . r_capacity, __ATOMIC_RELAXED );
+                if ( r_capacity == 0 || __atomic_load_n ( &_vertices[edge . dst_vertex] . label, __ATOMIC_RELAXED ) >= label )
+                    continue;
+
+                ++self . push_cnt;
+                const U flow = std::min ( excess, r_capacity );
+                auto && reverse_edge = _residual_network[edge . dst_vertex][edge . reverse_edge_index];
+                __atomic_fetch_sub ( &edge . r_capacity, flow, __ATOMIC_RELAXED );
+                __atomic_fetch_add ( &edge . reverse_r_capacity, flow, __ATOMIC_RELAXED );
+                __atomic_fetch_add ( &reverse_edge . r_capacity, flow, __ATOMIC_RELAXED );
+                __atomic_fetch_sub ( &reverse_edge . reverse_r_capacity, flow, __ATOMIC_RELAXED );
+                excess = __atomic_sub_fetch ( &record . excess, flow, __ATOMIC_SEQ_CST );
+                if ( __atomic_fetch_add ( &_vertices[edge . dst_vertex] . excess, flow, __ATOMIC_SEQ_CST ) == 0 )
+                    claim ( edge . dst_vertex, self );
+                if ( excess == 0 )
+                    return true;
+            }
+            return false;
+        }
+
+        void claim ( const T vertex, worker & self ) noexcept
+        {
+            if ( vertex == _source || vertex == _sink || _vertices[vertex] . claimed . test_and_set () )
+                return;
+            _claimed_cnt . fetch_add ( 1, std::memory_order_relaxed );
+            self . queue . push_back ( vertex );
+        }
+
+        void add_relabel_progress ( worker & self, std::size_t work ) noexcept
+        {
+            self . relabel_progress += work;
+            if ( self . relabel_progress < PROGRESS_BATCH )
+                return;
+            const auto progress = _relabel_progress . fetch_add ( self . relabel_progress, std::memory_order_relaxed )
+                                  + self . relabel_progress;
+            self . relabel_progress = 0;
+            if ( progress * GLOBAL_RELABEL_FREQ >= _relabel_threshold )
+                _stop . store ( true, std::memory_order_relaxed );
+        }
+
+        //hands the newest CHUNK vertices of the queue to the other threads
+        void give_chunk ( std::deque<T> & queue )
+        {
+            std::vector<T> chunk ( queue . end () - CHUNK, queue . end () );
+            queue . erase ( queue . end () - CHUNK, queue . end () );
+            std::lock_guard<std::mutex> guard ( _chunks_lock );
+            _chunks . push_back ( std::move ( chunk ) );
+            _chunk_cnt . fetch_add ( 1, std::memory_order_release );
+        }
+
+        bool take_chunk ( std::deque<T> & queue )
+        {
+            if ( _chunk_cnt . load ( std::memory_order_acquire ) == 0 )
+                return false;
+            std::lock_guard<std::mutex> guard ( _chunks_lock );
+            if ( _chunks . empty () )
+                return false;
+            queue . assign ( _chunks . back () . begin (), _chunks . back () . end () );
+            _chunks . pop_back ();
+            _chunk_cnt . fetch_sub ( 1, std::memory_order_relaxed );
+            return true;
+        }
+
+        //sets the labels to the distances to the sink with the threads stopped, and claims the vertices with excess
+        //which can reach it for the threads of the next epoch
+        void global_relabel ( )
+        {
+            ++_global_update_cnt;
+            const auto not_reached = static_cast<T> ( _residual_network . size () );
+            _levels . run ( _residual_network, _sink, not_reached, _vertices . get (), &max_flow_instance::vertex::label );
+            _chunks . clear ();
+            _chunk_cnt . store ( 0, std::memory_order_relaxed );
+
+            std::size_t claimed_cnt = 0;
+            #pragma omp parallel num_threads(static_cast<int> ( _thread_count )) reduction(+:claimed_cnt)
+            {
+                auto & queue = _workers[omp_get_thread_num ()] . queue;
+                queue . clear ();
+                #pragma omp for schedule(static)
+                for ( std::size_t i = 0; i < _residual_network . size (); ++i )
+                {
+                    _vertices[i] . claimed . clear ( std::memory_order_relaxed );
+                    if ( _vertices[i] . label != not_reached && _vertices[i] . excess > 0 && i != _sink && i != _source )
+                    {
+                        _vertices[i] . claimed . test_and_set ( std::memory_order_relaxed );
+                        queue . push_back ( i );
+                        ++claimed_cnt;
+                    }
+                }
+            }
+            _claimed_cnt . store ( claimed_cnt, std::memory_order_relaxed );
+        }
+    };
+}
+
+
+#endif //MAXFLOW_ASYNC_PUSH_RELABEL_H
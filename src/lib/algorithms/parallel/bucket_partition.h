@@ -0,0 +1,67 @@
+/*
+ * Stable parallel counting partition (one pass of an MSD radix sort). Every thread counts the bucket sizes of its own
+ * block of elements, the per-thread counts are turned into write positions by a prefix sum and every thread then
+ * scatters its block without any atomic operations. The resulting order does not depend on the number of threads.
+ */
+
+#ifndef MAXFLOW_BUCKET_PARTITION_H
+#define MAXFLOW_BUCKET_PARTITION_H
+
+#include <memory>
+#include <omp.h>
+
+namespace bucket_partition
+{
+    //key ( i ) returns the bucket of element i, write ( i, pos ) stores element i at position pos of the output
+    //returns bucket_cnt + 1 offsets, bucket b occupies positions [offsets[b], offsets[b + 1])
+    template <typename key_fn, typename write_fn>
+    std::unique_ptr<std::size_t[]> partition ( std::size_t size, std::size_t bucket_cnt, std::size_t thread_count,
+                                               key_fn key, write_fn write )
+    {
+        auto offsets = std::make_unique<std::size_t[]> ( bucket_cnt + 1 );
+        auto counts = std::make_unique<std::size_t[]> ( thread_count * bucket_cnt );
+
+        #pragma omp parallel num_threads(thread_count)
+        {
+            const std::size_t thr_id = omp_get_thread_num ();
+            const std::size_t threads = omp_get_num_threads ();
+            const std::size_t low = size * thr_id / threads, high = size * ( thr_id + 1 ) / threads;
+            auto * count = counts . get () + thr_id * bucket_cnt;
+
+            for ( std::size_t i = low; i < high; ++i )
+                ++count[key ( i )];
+
+            #pragma omp barrier
+            #pragma omp single
+            {
+                std::size_t sum = 0;
+                for ( std::size_t b = 0; b < bucket_cnt; ++b )
+                {
+                    offsets[b] = sum;
+                    for ( std::size_t t = 0; t < threads; ++t )
+                    {
+                        auto cnt = counts[t * bucket_cnt + b];
+                        counts[t * bucket_cnt + b] = sum;
+                        sum += cnt;
+                    }
+                }
+                offsets[bucket_cnt] = sum;
+            }
+
+            for ( std::size_t i = low; i < high; ++i )
+                write ( i, count[key ( i )]++ );
+        }
+        return offsets;
+    }
+
+    //number of low bits dropped from a vertex id so that vertices map to at most max_buckets buckets
+    inline unsigned bucket_shift ( std::size_t vertex_cnt, std::size_t max_buckets = std::size_t { 1 } << 14 ) noexcept
+    {
+        unsigned shift = 0;
+        while ( ( ( vertex_cnt - 1 ) >> shift ) >= max_buckets )
+            ++shift;
+        return shift;
+    }
+}
+
+#endif //MAXFLOW_BUCKET_PARTITION_H
@@ -0,0 +1,205 @@
+/*
+ * Level synchronous, direction optimizing breadth first search over the reverse residual arcs, the global relabel of
+ * the push-relabel instances that run on more than one thread. It is described in
+ * Beamer, Scott and Asanovic, Krste and Patterson, David, Direction-Optimizing Breadth-First Search, SC, 2012.
+ *
+ * A top-down step splits the vertices of the last level among the threads, which claim the unreached heads of their
+ * arcs with a compare and swap on the label. Once the arcs of the last level outnumber the arcs left to explore by
+ * ALPHA to one, which happens after a step or two on dense graphs with a small diameter, the search goes bottom-up:
+ * every unreached vertex looks for an arc into the last level, marked in a bitmap, and stops at the first one, so
+ * neither the arcs of the level nor the labels are contended. The search goes top-down again once the levels shrink
+ * below one BETA'th of the vertices. Either way the threads collect the vertices they reach in buffers of their own,
+ * which are copied behind the level in the order of the threads, so that the vertices end up in breadth first order
+ * with the levels stored one after the other.
+ */
+
+#ifndef MAXFLOW_PARALLEL_BFS_H
+#define MAXFLOW_PARALLEL_BFS_H
+
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <omp.h>
+#include <algorithm>
+#include "../../prefetch.h"
+
+#ifndef CACHE_LINE_SIZE
+#define CACHE_LINE_SIZE 64
+#endif
+
+namespace parallel_bfs
+{
+    template <typename T>
+    class levels
+    {
+        struct alignas (CACHE_LINE_SIZE) aligned_vector
+        {
+            std::vector<T> data;
+            std::size_t offset;
+            std::size_t arcs;
+        };
+
+        std::unique_ptr<T[]> _order;
+        std::unique_ptr<uint64_t[]> _frontier;
+        std::vector<std::size_t> _level_start;
+        std::unique_ptr<aligned_vector[]> _found;
+        const std::size_t _size, _thread_count;
+
+        //statistics
+        uint64_t _step_cnt { 0 }, _bottom_up_cnt { 0 };
+
+        static constexpr std::size_t ALPHA = 15, BETA = 18;
+
+        bool in_frontier ( T vertex ) const noexcept
+        {
+            return ( _frontier[vertex >> 6] >> ( vertex & 63 ) ) & 1;
+        }
+
+    public:
+        levels ( std::size_t size, std::size_t thread_count ) : _size ( size ), _thread_count ( thread_count )
+        {
+        }
+
+        //sets records[v] .* label to the distance of v to root over the arcs with reverse_r_capacity > 0, and to
+        //not_reached for the vertices which cannot reach root
+        template <typename network, typename record>
+        void run ( const network & graph, T root, T not_reached, record * records, T record::* label )
+        {
+            if ( !_order )
+            {
+                _order = std::make_unique<T[]> ( _size );
+                _frontier = std::make_unique<uint64_t[]> ( ( _size + 63 ) / 64 );
+                _found = std::make_unique<aligned_vector[]> ( _thread_count );
+            }
+            const int threads = static_cast<int> ( _thread_count );
+
+            #pragma omp parallel for schedule(static) num_threads(threads)
+            for ( std::size_t i = 0; i < _size; ++i )
+                records[i] .* label = not_reached;
+
+            records[root] .* label = 0;
+            _order[0] = root;
+            _level_start . assign ( { 0, 1 } );
+            std::size_t first = 0, last = 1, unexplored_arcs = graph . arc_count () - graph[root] . size ();
+            bool bottom_up = false;
+            T distance = 0;
+
+            #pragma omp parallel num_threads(threads)
+            {
+                auto & found = _found[omp_get_thread_num ()];
+                while ( first < last )
+                {
+                    found . data . clear ();
+                    found . arcs = 0;
+                    if ( bottom_up )
+                    {
+                        #pragma omp for schedule(dynamic, 1024)
+                        for ( std::size_t v = 0; v < _size; ++v )
+                        {
+                            if ( records[v] .* label != not_reached )
+                                continue;
+                            for ( auto && edge : graph[v] )
+                            {
+                                if ( edge . r_capacity > 0 && in_frontier ( edge . dst_vertex ) )
+                                {
+                                    records[v] .* label = distance + 1;
+                                    found . data . push_back ( v );
+                                    found . arcs += graph[v] . size ();
+                                    break;
+                                }
+                            }
+                        }
+                    } else
+                    {
+                        #pragma omp for schedule(dynamic, 16)
+                        for ( std::size_t i = first; i < last; ++i )
+                        {
+                            prefetch::queue<prefetch::default_distance> ( graph, records, i, last,
+                                                                          [this] ( std::size_t k ) { return _order[k]; } );
+                            for ( auto && edge : graph[_order[i]] )
+                            {
+                                if ( edge . reverse_r_capacity == 0 )
+                                    continue;
+                                T & head = records[edge . dst_vertex] .* label, expected = not_reached;
+                                if ( __atomic_load_n ( &head, __ATOMIC_RELAXED ) == not_reached &&
+                                     __atomic_compare_exchange_n ( &head, &expected, distance + 1, false,
+                                                                   __ATOMIC_RELAXED, __ATOMIC_RELAXED ) )
+                                {
+                                    found . data . push_back ( edge . dst_vertex );
+                                    found . arcs += graph[edge . dst_vertex] . size ();
+                                }
+                            }
+                        }
+                    }
+
+                    #pragma omp single
+                    {
+                        ++_step_cnt;
+                        _bottom_up_cnt += bottom_up;
+                        std::size_t next = last, arcs = 0;
+                        for ( int t = 0; t < omp_get_num_threads (); ++t )
+                        {
+                            _found[t] . offset = next;
+                            next += _found[t] . data . size ();
+                            arcs += _found[t] . arcs;
+                        }
+                        const std::size_t level_size = next - last, previous_size = last - first;
+                        unexplored_arcs -= arcs;
+                        if ( !bottom_up )
+                            bottom_up = arcs > unexplored_arcs / ALPHA;
+                        else
+                            bottom_up = level_size >= previous_size || level_size > _size / BETA;
+                        if ( bottom_up )
+                            std::fill_n ( _frontier . get (), ( _size + 63 ) / 64, 0 );
+                        first = last;
+                        last = next;
+                        ++distance;
+                        _level_start . push_back ( last );
+                    }
+
+                    std::copy ( found . data . begin (), found . data . end (), _order . get () + found . offset );
+                    if ( bottom_up )
+                        for ( auto v : found . data )
+                            __atomic_fetch_or ( &_frontier[v >> 6], uint64_t ( 1 ) << ( v & 63 ), __ATOMIC_RELAXED );
+                    #pragma omp barrier
+                }
+            }
+            _level_start . pop_back ();
+        }
+
+        //the number of levels of the last search, level 0 holding root only
+        std::size_t count ( ) const noexcept
+        {
+            return _level_start . size () - 1;
+        }
+
+        const T * begin ( std::size_t level ) const noexcept
+        {
+            return _order . get () + _level_start[level];
+        }
+
+        const T * end ( std::size_t level ) const noexcept
+        {
+            return _order . get () + _level_start[level + 1];
+        }
+
+        //the reached vertices in breadth first order
+        const T * end ( ) const noexcept
+        {
+            return _order . get () + _level_start . back ();
+        }
+
+        //the steps of all searches so far, and how many of them went bottom-up
+        uint64_t steps ( ) const noexcept
+        {
+            return _step_cnt;
+        }
+
+        uint64_t bottom_up_steps ( ) const noexcept
+        {
+            return _bottom_up_cnt;
+        }
+    };
+}
+
+#endif //MAXFLOW_PARALLEL_BFS_H
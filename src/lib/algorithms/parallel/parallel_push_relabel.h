@@ -16,6 +16,11 @@
 #include <omp.h>
 #include <algorithm>
 #include "../../common_types.h"
+#include "../../prefetch.h"
+#include "../../min_label.h"
+#include "../sequential/preflow_conversion.h"
+#include "parallel_bfs.h"
+#include "prefix_sum.h"
 #include "../../data_structures/queue.h"
 #include "../../data_structures/thread_local_buffer_pool.h"
 
@@ -37,13 +42,30 @@ namespace parallel_push_relabel
             std::atomic_flag discovered = ATOMIC_FLAG_INIT;
         };
 
+        //time a thread spends pushing and relabeling, and waiting for the other threads at the end of the stages
+        struct alignas (CACHE_LINE_SIZE) thread_time
+        {
+            double busy { 0 }, idle { 0 };
+
+            void add ( double start, double idle_start, double end ) noexcept
+            {
+                busy += idle_start - start;
+                idle += end - idle_start;
+            }
+        };
+
         vector<vector<cached_edge<T, U>>> & _residual_network;
         std::unique_ptr<vertex[]> _vertices;
         std::unique_ptr<T[]> _active { };
+        std::unique_ptr<std::size_t[]> _arc_prefix, _block_sums;
         data_structures::thread_local_buffer_pool<T> _pool;
+        parallel_bfs::levels<T> _levels;
         T _source, _sink, _relabel_threshold, _active_cnt;
         std::size_t _relabel_progress;
         const T _thread_count;
+        #ifdef DEBUG
+        std::unique_ptr<thread_time[]> _thread_times;
+        #endif
     public:
         max_flow_instance ( vector<vector<cached_edge<T, U>>> & graph, T source, T sink,
                             std::size_t thread_count = static_cast<size_t>(omp_get_max_threads ()) )
@@ -51,11 +73,17 @@ namespace parallel_push_relabel
                 _residual_network ( graph ),
                 _vertices ( std::make_unique<vertex[]> ( _residual_network . size () ) ),
                 _active ( std::make_unique<T[]> ( _residual_network . size () ) ),
+                _arc_prefix ( std::make_unique<std::size_t[]> ( _residual_network . size () + 1 ) ),
+                _block_sums ( std::make_unique<std::size_t[]> ( thread_count + 1 ) ),
                 _pool ( data_structures::thread_local_buffer_pool<T> ( thread_count, _residual_network . size () ) ),
+                _levels ( _residual_network . size (), thread_count ),
                 _source ( source ), _sink ( sink ), _active_cnt ( 0 ), _relabel_progress ( 0 ),
                 _thread_count ( thread_count )
         {
             omp_set_num_threads ( static_cast<int> ( _thread_count ) );
+            #ifdef DEBUG
+            _thread_times = std::make_unique<thread_time[]> ( _thread_count );
+            #endif
             init ();
         }
 
@@ -69,17 +97,23 @@ namespace parallel_push_relabel
 
             #ifdef DEBUG
             std::cout << "global updates:\t" << _global_update_cnt << std::endl;
+            std::cout << "bfs steps:\t" << _levels . steps () << " (" << _levels . bottom_up_steps () << " bottom-up)" << std::endl;
             std::cout << "phase cnt: " << _phase_cnt << std::endl;
             std::cout << "pushes: " << _push_cnt << std::endl;
+            for ( std::size_t i = 0; i < _thread_count; ++i )
+                std::cout << "thread " << i << ":\tbusy " << _thread_times[i] . busy * 1000 << " ms, idle "
+                          << _thread_times[i] . idle * 1000 << " ms" << std::endl;
             #endif
             return _vertices[_sink] . new_excess + _vertices[_sink] . excess;
         }
 
-        void preflow_to_flow ( )
+        //returns the excess left by find_max_flow to the source, capacity_of ( arc ) is the capacity of the arc with
+        //index arc, see preflow_conversion
+        template <typename capacity_fn>
+        void preflow_to_flow ( capacity_fn && capacity_of )
         {
-            std::swap ( _source, _sink );
-            find_max_flow_inner ();
-            std::swap ( _source, _sink );
+            preflow_conversion::preflow_to_flow ( _residual_network, _source, _sink,
+                                                  [this] ( T v ) -> U & { return _vertices[v] . excess; }, capacity_of );
             #ifdef DEBUG
             for ( std::size_t i = 0; i < _residual_network . size(); ++i )
                 if ( i != _source && i != _sink )
@@ -95,6 +129,7 @@ namespace parallel_push_relabel
 
     private:
         static constexpr T ALPHA = 6, BETA = 12;
+        static constexpr std::size_t PREFETCH_DISTANCE = prefetch::default_distance;
         static constexpr double GLOBAL_RELABEL_FREQ = 0.5;
 
         void init ( ) noexcept
@@ -102,7 +137,7 @@ namespace parallel_push_relabel
             #pragma omp parallel for schedule(static)
             for ( std::size_t i = 0; i < _residual_network[_source] . size (); ++i )
             {
-                auto & edge = _residual_network[_source][i];
+                auto && edge = _residual_network[_source][i];
                 _vertices[edge . dst_vertex] . excess = edge . r_capacity;
                 edge . reverse_r_capacity += edge . r_capacity;
                 _residual_network[edge . dst_vertex][edge . reverse_edge_index] . r_capacity += edge . r_capacity;
@@ -130,25 +165,56 @@ namespace parallel_push_relabel
                 ++_phase_cnt;
                 uint64_t push_cnt_per_phase = 0;
 
-                #pragma omp parallel
+                #pragma omp parallel num_threads(static_cast<int> ( _thread_count ))
                 {
-                    #pragma omp for schedule(static) reduction(+:push_cnt_per_phase)
-                    for ( T i = 0; i < _active_cnt; ++i )
+                    //stage 0, the active vertices are split among the threads by their arcs
+                    const auto [low, high] = split_active ();
+                    auto thr_id = omp_get_thread_num ();
+                    #ifdef DEBUG
+                    double start = omp_get_wtime (), idle_start;
+                    #endif
+
+                    //stage 1
+                    uint64_t push_cnt = 0;
+                    for ( std::size_t i = low; i < high; ++i )
                     {
-                        auto thr_id = omp_get_thread_num ();
                         auto vertex = _active[i];
+                        prefetch::queue<PREFETCH_DISTANCE> ( _residual_network, _vertices . get (), i, high,
+                                                             [this] ( std::size_t k ) { return _active[k]; } );
                         if ( _vertices[vertex] . label == _residual_network . size () )
                             continue;
-                        push ( vertex, _vertices[vertex] . label, thr_id, push_cnt_per_phase );
+                        push ( vertex, _vertices[vertex] . label, thr_id, push_cnt );
                     }
+                    #pragma omp atomic
+                    push_cnt_per_phase += push_cnt;
+                    #ifdef DEBUG
+                    idle_start = omp_get_wtime ();
+                    #endif
+                    #pragma omp barrier
+                    #ifdef DEBUG
+                    _thread_times[thr_id] . add ( start, idle_start, omp_get_wtime () );
+                    start = omp_get_wtime ();
+                    #endif
+
                     //stage 2
-                    #pragma omp for schedule(static) reduction(+:_relabel_progress)
-                    for ( T i = 0; i < _active_cnt; ++i )
+                    std::size_t relabel_progress = 0;
+                    for ( std::size_t i = low; i < high; ++i )
                     {
-                        auto thr_id = omp_get_thread_num ();
                         auto vertex = _active[i];
-                        relabel ( vertex, thr_id, _relabel_progress );
+                        prefetch::queue<PREFETCH_DISTANCE> ( _residual_network, _vertices . get (), i, high,
+                                                             [this] ( std::size_t k ) { return _active[k]; } );
+                        relabel ( vertex, thr_id, relabel_progress );
                     }
+                    #pragma omp atomic
+                    _relabel_progress += relabel_progress;
+                    #ifdef DEBUG
+                    idle_start = omp_get_wtime ();
+                    #endif
+                    #pragma omp barrier
+                    #ifdef DEBUG
+                    _thread_times[thr_id] . add ( start, idle_start, omp_get_wtime () );
+                    #endif
+
                     //stage 3
                     #pragma omp for schedule(static)
                     for ( T i = 0; i < _active_cnt; ++i )
@@ -181,10 +247,29 @@ namespace parallel_push_relabel
             }
         }
 
+        //called by every thread of the phase, returns the range of _active the thread pushes and relabels. The ranges
+        //hold about as many arcs each, a vertex weighing its arcs plus one, so that the threads which get the vertices of
+        //the highest degrees do not keep the others waiting at the barriers.
+        std::pair<std::size_t, std::size_t> split_active ( ) noexcept
+        {
+            #pragma omp for schedule(static)
+            for ( std::size_t i = 0; i <= _active_cnt; ++i )
+                _arc_prefix[i] = i < _active_cnt ? _residual_network[_active[i]] . size () + 1 : 0;
+            const std::size_t total = prefix_sum::team_exclusive_scan ( _arc_prefix . get (), _active_cnt + 1,
+                                                                        _block_sums . get () );
+
+            const std::size_t thr_id = omp_get_thread_num (), threads = omp_get_num_threads ();
+            auto bound = [this, total, threads] ( std::size_t t ) {
+                return static_cast<std::size_t> ( std::lower_bound ( _arc_prefix . get (), _arc_prefix . get () + _active_cnt,
+                                                                     total * t / threads ) - _arc_prefix . get () );
+            };
+            return { bound ( thr_id ), bound ( thr_id + 1 ) };
+        }
+
         inline void push ( const T vertex, const T label, int thr_id, uint64_t & push_cnt ) noexcept
         {
             const auto target_label = label - 1;
-            for ( auto & edge : _residual_network[vertex] )
+            for ( auto && edge : _residual_network[vertex] )
             {
                 if ( edge . r_capacity > 0 && _vertices[edge . dst_vertex] . label == target_label )
                 {
@@ -227,14 +312,9 @@ namespace parallel_push_relabel
 
         inline T calculate_new_label ( const T vertex ) noexcept
         {
-            T increase_to = _residual_network . size () - 1;
-            for ( auto & edge : _residual_network[vertex] )
-            {
-                if ( edge . r_capacity == 0 )
-                    continue;
-
-                increase_to = std::min ( increase_to, _vertices[edge . dst_vertex] . label );
-            }
+            const T increase_to = min_label::over_residual_arcs ( _residual_network[vertex], _vertices . get (),
+                                                                  &max_flow_instance::vertex::label,
+                                                                  static_cast<T> ( _residual_network . size () - 1 ) );
             return increase_to + 1;
         }
 
@@ -243,48 +323,15 @@ namespace parallel_push_relabel
         {
             ++_global_update_cnt;
             const auto not_reached = _residual_network . size ();
-
-            #pragma omp parallel for schedule(static)
-            for ( std::size_t i = 0; i < _residual_network . size (); ++i )
-                _vertices[i] . label = not_reached;
-
-            _vertices[_sink] . label = 0;
-            _vertices[_sink] . discovered . test_and_set ();
             assert ( _pool . empty () );
-            _active[0] = _sink;
-            std::size_t current_queue_size = 1;
-            T current_distance = 0;
-
-            while ( current_queue_size > 0 )
-            {
-                #pragma omp parallel for schedule(static)
-                for ( std::size_t i = 0; i < current_queue_size; ++i )
-                {
-                    auto thr_id = omp_get_thread_num ();
-                    auto current_vertex = _active[i];
-
-                    for ( auto edge : _residual_network[current_vertex] )
-                    {
-                        if ( edge . reverse_r_capacity > 0 )
-                        {
-                            if ( !_vertices[edge . dst_vertex] . discovered . test_and_set ( std::memory_order_relaxed ) )
-                            {
-                                _vertices[edge . dst_vertex] . label = current_distance + 1;
-                                _pool . push_back ( edge . dst_vertex, static_cast<std::size_t>(thr_id) );
-                            }
-                        }
-                    }
-                }
-                current_queue_size = _pool . swap_data ( _active );
-                ++current_distance;
-            }
-
+            _levels . run ( _residual_network, _sink, static_cast<T> ( not_reached ), _vertices . get (),
+                            &max_flow_instance::vertex::label );
 
             #pragma omp parallel for schedule(static)
             for ( std::size_t i = 0; i < _residual_network . size (); ++i )
             {
                 auto thr_id = omp_get_thread_num ();
-                if ( _vertices[i] . label != not_reached && _vertices[i] . excess > 0 && i != _sink )
+                if ( _vertices[i] . label != not_reached && _vertices[i] . excess > 0 && i != _sink && i != _source )
                     _pool . push_back ( i, static_cast<size_t>(thr_id) );
                 _vertices[i] . discovered . clear ( std::memory_order_relaxed );
             }
@@ -0,0 +1,64 @@
+/*
+ * Parallel exclusive prefix sum. Every thread sums its own block, the block sums are scanned and every thread then
+ * rewrites its block starting from the sum of the preceding blocks.
+ */
+
+#ifndef MAXFLOW_PREFIX_SUM_H
+#define MAXFLOW_PREFIX_SUM_H
+
+#include <memory>
+#include <omp.h>
+
+namespace prefix_sum
+{
+    //the scan below, run by all threads of the enclosing parallel region, block_sums holding at least one element more
+    //than there are threads. Every thread returns the sum of all elements.
+    template <typename T>
+    T team_exclusive_scan ( T * data, std::size_t size, T * block_sums ) noexcept
+    {
+        const std::size_t thr_id = omp_get_thread_num ();
+        const std::size_t threads = omp_get_num_threads ();
+        const std::size_t low = size * thr_id / threads, high = size * ( thr_id + 1 ) / threads;
+
+        T sum = 0;
+        for ( std::size_t i = low; i < high; ++i )
+            sum += data[i];
+        block_sums[thr_id + 1] = sum;
+
+        #pragma omp barrier
+        #pragma omp single
+        {
+            block_sums[0] = 0;
+            for ( std::size_t i = 0; i < threads; ++i )
+                block_sums[i + 1] += block_sums[i];
+        }
+
+        T running = block_sums[thr_id];
+        for ( std::size_t i = low; i < high; ++i )
+        {
+            auto value = data[i];
+            data[i] = running;
+            running += value;
+        }
+        #pragma omp barrier
+        return block_sums[threads];
+    }
+
+    //replaces data[i] with data[0] + ... + data[i - 1] and returns the sum of all elements
+    template <typename T>
+    T exclusive_scan ( T * data, std::size_t size, std::size_t thread_count ) noexcept
+    {
+        auto block_sums = std::make_unique<T[]> ( thread_count + 1 );
+        T total = 0;
+
+        #pragma omp parallel num_threads(thread_count)
+        {
+            const T sum = team_exclusive_scan ( data, size, block_sums . get () );
+            #pragma omp master
+            total = sum;
+        }
+        return total;
+    }
+}
+
+#endif //MAXFLOW_PREFIX_SUM_H
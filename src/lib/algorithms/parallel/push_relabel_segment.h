@@ -6,8 +6,10 @@
 #define MAXFLOW_GOLDBERG_CR_H
 
 #include "../../common_types.h"
+#include "../../prefetch.h"
+#include "../sequential/preflow_conversion.h"
 #include "../../data_structures/linked_list.h"
-#include "../../data_structures/thread_local_buffer_pool.h"
+#include "parallel_bfs.h"
 #include "partitioning.h"
 #include <memory>
 #include <cassert>
@@ -34,7 +36,6 @@ namespace push_relabel_segment
             U excess { 0 };
             T label;
             T original_label;
-            std::atomic_flag discovered = ATOMIC_FLAG_INIT;
         };
 
         struct label_info
@@ -52,8 +53,7 @@ namespace push_relabel_segment
         vector<vector<cached_edge<T, U>>> & _residual_network;
         std::unique_ptr<label_info[]> _labels;
         std::unique_ptr<vertex[]> _vertices;
-        data_structures::thread_local_buffer_pool<T> _pool;
-        std::unique_ptr<T[]> _q;
+        parallel_bfs::levels<T> _levels;
         std::unique_ptr<label_info[]> _thread_local_labels;
         T _source, _sink, _highest_active { 0 }, _highest_vertex { 0 };
         std::size_t _thread_count, _original_relabel_threshold { 0 };
@@ -68,8 +68,7 @@ namespace push_relabel_segment
                 _residual_network ( graph ),
                 _labels ( std::make_unique<label_info[]> ( _residual_network . size () + 1 ) ),
                 _vertices ( std::make_unique<vertex[]> ( _residual_network . size () ) ),
-                _pool ( data_structures::thread_local_buffer_pool<T> { thread_count, _residual_network . size () } ),
-                _q ( std::make_unique<T[]> ( _residual_network . size () ) ),
+                _levels ( _residual_network . size (), thread_count ),
                 _thread_local_labels ( std::make_unique<label_info[]> ( thread_count ) ),
                 _source ( source ), _sink ( sink ), _thread_count ( thread_count ),
                 _max_thread_count ( thread_count )
@@ -89,12 +88,13 @@ namespace push_relabel_segment
             return _vertices[_sink] . excess;
         }
 
-        void preflow_to_flow ( )
+        //returns the excess left by find_max_flow to the source, capacity_of ( arc ) is the capacity of the arc with
+        //index arc, see preflow_conversion
+        template <typename capacity_fn>
+        void preflow_to_flow ( capacity_fn && capacity_of )
         {
-            std::swap ( _source, _sink );
-            _highest_vertex = _residual_network . size ();
-            find_max_flow ();
-            std::swap ( _source, _sink );
+            preflow_conversion::preflow_to_flow ( _residual_network, _source, _sink,
+                                                  [this] ( T v ) -> U & { return _vertices[v] . excess; }, capacity_of );
             #ifdef DEBUG
             for ( std::size_t i = 0; i < _residual_network . size(); ++i )
                 if ( i != _source && i != _sink )
@@ -110,6 +110,7 @@ namespace push_relabel_segment
 
     private:
         static constexpr T ALPHA = 6, BETA = 12;
+        static constexpr std::size_t PREFETCH_DISTANCE = prefetch::default_distance;
         static constexpr double GLOBAL_RELABEL_FREQ = 1;
         static constexpr T min_active_per_thread = 10;
 
@@ -118,7 +119,7 @@ namespace push_relabel_segment
             #pragma omp parallel for schedule(static)
             for ( std::size_t i = 0; i < _residual_network[_source] . size (); ++i )
             {
-                auto & edge = _residual_network[_source][i];
+                auto && edge = _residual_network[_source][i];
                 _vertices[edge . dst_vertex] . excess = edge . r_capacity;
                 edge . reverse_r_capacity += edge . r_capacity;
                 _residual_network[edge . dst_vertex][edge . reverse_edge_index] . r_capacity += edge . r_capacity;
@@ -261,7 +262,7 @@ namespace push_relabel_segment
         {
             const auto target_label = label - 1;
 
-            for ( auto & edge : _residual_network[vertex] )
+            for ( auto && edge : _residual_network[vertex] )
             {
                 if ( edge . r_capacity > 0 &&
                      same_thread ( _vertices[edge . dst_vertex] . original_label, data . low, data . high )
@@ -316,7 +317,7 @@ namespace push_relabel_segment
         inline T calculate_new_label ( const T vertex, thread_local_data & data ) noexcept
         {
             T increase_to = data . high - 1;
-            for ( auto & edge :  _residual_network[vertex] )
+            for ( auto && edge :  _residual_network[vertex] )
             {
                 if ( edge . r_capacity == 0 ||
                      !same_thread ( _vertices[edge . dst_vertex] . original_label, data . low, data . high ) )
@@ -334,68 +335,36 @@ namespace push_relabel_segment
             omp_set_num_threads ( static_cast<int> ( _max_thread_count ) );
             const auto not_reached = _residual_network . size ();
 
-            #pragma omp parallel for schedule(static)
-            for ( std::size_t i = 0; i < _residual_network . size (); ++i )
-            {
-                _vertices[i] . discovered . clear ( std::memory_order_relaxed );
-                _vertices[i] . label = _vertices[i] . original_label = not_reached;
-            }
-
             #pragma omp parallel for schedule(static)
             for ( std::size_t i = 0; i <= _highest_vertex; ++i )
                 _labels[i] . reset ();
 
-            _vertices[_sink] . label = _vertices[_sink] . original_label = 0;
-            _vertices[_sink] . discovered . test_and_set ( std::memory_order_relaxed );
-            _highest_active = 0;
+            _levels . run ( _residual_network, _sink, static_cast<T> ( not_reached ), _vertices . get (),
+                            &max_flow_instance::vertex::label );
 
-            _q[0] = _sink;
-            std::size_t current_queue_size = 1;
-            T current_distance = 0;
+            #pragma omp parallel for schedule(static)
+            for ( std::size_t i = 0; i < _residual_network . size (); ++i )
+                _vertices[i] . original_label = _vertices[i] . label;
 
-            while ( current_queue_size > 0 )
+            //every level fills the lists of its own label, so the levels are independent of each other
+            const std::size_t level_cnt = _levels . count ();
+            T highest_active = 0;
+            #pragma omp parallel for schedule(dynamic, 1) reduction(max:highest_active)
+            for ( std::size_t level = 1; level < level_cnt; ++level )
             {
-                #pragma omp parallel for schedule(static)
-                for ( std::size_t i = 0; i < current_queue_size; ++i )
+                for ( auto * it = _levels . begin ( level ); it != _levels . end ( level ); ++it )
                 {
-                    auto thr_id = omp_get_thread_num ();
-                    auto current_vertex = _q[i];
-
-                    for ( auto edge : _residual_network[current_vertex] )
+                    auto * node = &_vertices[*it];
+                    if ( node -> excess > 0 && *it != _source )
                     {
-                        if ( edge . reverse_r_capacity > 0 )
-                        {
-                            if ( !_vertices[edge . dst_vertex] . discovered . test_and_set ( std::memory_order_relaxed ) )
-                            {
-                                _vertices[edge . dst_vertex] . label = current_distance + 1;
-                                _vertices[edge . dst_vertex] . original_label = current_distance + 1;
-                                _pool . push_back ( edge . dst_vertex, static_cast<std::size_t>(thr_id) );
-
-                                auto * node = &_vertices[edge . dst_vertex];
-                                if ( _vertices[edge . dst_vertex] . excess > 0 )
-                                    _thread_local_labels[thr_id] . active_vertices . push ( node );
-                                else
-                                    _thread_local_labels[thr_id] . inactive_vertices . push ( node );
-                            }
-                        }
-                    }
-                }
-
-                current_queue_size = _pool . swap_data ( _q );
-                ++current_distance;
-
-                for ( std::size_t i = 0; i < _max_thread_count; ++i ) //append together all thread_local info
-                {
-                    _labels[current_distance] . active_vertices . append_list ( _thread_local_labels[i] . active_vertices );
-                    _labels[current_distance] . inactive_vertices . append_list (
-                            _thread_local_labels[i] . inactive_vertices );
+                        highest_active = static_cast<T> ( level );
+                        _labels[level] . active_vertices . push ( node );
+                    } else
+                        _labels[level] . inactive_vertices . push ( node );
                 }
-
-                if ( !_labels[current_distance] . active_vertices . empty () )
-                    _highest_active = current_distance;
             }
-
-            _highest_vertex = current_distance - 1;
+            _highest_active = highest_active;
+            _highest_vertex = static_cast<T> ( level_cnt - 1 );
 
             omp_set_num_threads ( static_cast<int> ( _thread_count ) );
             auto end = std::chrono::high_resolution_clock::now ();
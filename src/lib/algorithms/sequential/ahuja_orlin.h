@@ -1,6 +1,9 @@
 /*
  * Implementation closely follows pseudocode descriped in the original paper:
  * K. Ahuja, Ravindra and Orlin, James, A Fast and Simple Algorithm for the Maximum Flow Problem, Operations Research, 1989
+ *
+ * Given more than one thread, the global relabels run as a parallel breadth first search and the lists of the labels
+ * are rebuilt in parallel, while the vertices are discharged by a single thread.
  */
 
 #ifndef MAXFLOW_AHUJA_ORLIN_H
@@ -8,8 +11,13 @@
 
 
 #include "../../common_types.h"
+#include "../../prefetch.h"
+#include "../../min_label.h"
 #include "../../data_structures/queue.h"
 #include "../../data_structures/linked_list.h"
+#include "preflow_update.h"
+#include "preflow_conversion.h"
+#include "../parallel/parallel_bfs.h"
 #include <memory>
 #include <chrono>
 #include <cmath>
@@ -40,9 +48,13 @@ namespace ahuja_orlin
         std::unique_ptr<label_info[]> _labels;
         std::unique_ptr<vertex[]> _vertices;
         data_structures::queue<pair> _distance_q;
+        parallel_bfs::levels<T> _levels;
         T _source, _sink, _lowest_active { 0 }, _highest_active { 0 }, _highest_vertex { 0 }, _relabel_progress {
                 0 }, _relabel_threshold;
         U _max_cap;
+        const std::size_t _thread_count;
+
+        preflow_update::arc_updater<T, U> _updater;
 
         //statistics
         uint64_t _push_cnt { 0 }, _relabel_cnt { 0 }, _gap_cnt { 0 }, _gap_nodes { 0 }, _global_relabel_cnt { 0 };
@@ -53,7 +65,8 @@ namespace ahuja_orlin
                 _labels ( std::make_unique<label_info[]> ( _residual_network . size () + 1 ) ),
                 _vertices ( std::make_unique<vertex[]> ( _residual_network . size () ) ),
                 _distance_q ( data_structures::queue<pair> { _residual_network . size () } ),
-                _source ( source ), _sink ( sink )
+                _levels ( _residual_network . size (), nthread ),
+                _source ( source ), _sink ( sink ), _thread_count ( nthread )
         {
             init ();
         }
@@ -77,12 +90,13 @@ namespace ahuja_orlin
             return _vertices[_sink] . excess;
         }
 
-        void preflow_to_flow ( )
+        //returns the excess left by find_max_flow to the source, capacity_of ( arc ) is the capacity of the arc with
+        //index arc, see preflow_conversion
+        template <typename capacity_fn>
+        void preflow_to_flow ( capacity_fn && capacity_of )
         {
-            std::swap ( _source, _sink );
-            _highest_vertex = _residual_network . size ();
-            find_max_flow_inner ();
-            std::swap ( _source, _sink );
+            preflow_conversion::preflow_to_flow ( _residual_network, _source, _sink,
+                                                  [this] ( T v ) -> U & { return _vertices[v] . excess; }, capacity_of );
             #ifdef DEBUG
             for ( std::size_t i = 0; i < _residual_network . size(); ++i )
                 if ( i != _source && i != _sink )
@@ -96,23 +110,37 @@ namespace ahuja_orlin
             return std::move ( _residual_network );
         }
 
+        //changes the capacity of an arc of the network after find_max_flow, see preflow_update
+        template <typename capacity_fn>
+        void update_capacity ( T vertex, std::size_t idx, U capacity, U new_capacity, capacity_fn && capacity_of )
+        {
+            _updater ( _residual_network, vertex, idx, capacity, new_capacity, _source, _sink,
+                       [this] ( T v ) -> U & { return _vertices[v] . excess; }, capacity_of );
+        }
+
+        //continues from the preflow left by find_max_flow and update_capacity instead of starting over
+        U resume ( )
+        {
+            saturate_source_arcs ();
+            _max_cap = 1;
+            for ( std::size_t i = 0; i < _residual_network . size (); ++i )
+                if ( i != _source && i != _sink )
+                    _max_cap = std::max ( _max_cap, _vertices[i] . excess );
+            _highest_vertex = _residual_network . size ();
+            return find_max_flow ();
+        }
+
     private:
         static constexpr T ALPHA = 6, BETA = 12;
+        static constexpr std::size_t PREFETCH_DISTANCE = prefetch::default_distance;
         static constexpr double GLOBAL_RELABEL_FREQ = 0.5;
 
         void init ( ) noexcept
         {
             _max_cap = 0;
-            for ( auto & edge : _residual_network[_source] )
-            {
+            for ( auto && edge : _residual_network[_source] )
                 _max_cap = std::max ( _max_cap, edge . r_capacity );
-                _vertices[edge . dst_vertex] . excess = edge . r_capacity;
-                edge . reverse_r_capacity += edge . r_capacity;
-                _residual_network[edge . dst_vertex][edge . reverse_edge_index] . r_capacity += edge . r_capacity;
-                _residual_network[edge . dst_vertex][edge . reverse_edge_index] . reverse_r_capacity -= edge . r_capacity;
-                edge . r_capacity = 0;
-            }
-            _push_cnt += _residual_network[_source] . size ();
+            saturate_source_arcs ();
 
             T m = 0;
             for ( std::size_t i = 0; i < _residual_network . size (); ++i )
@@ -122,6 +150,20 @@ namespace ahuja_orlin
         }
 
 
+        void saturate_source_arcs ( ) noexcept
+        {
+            for ( auto && edge : _residual_network[_source] )
+            {
+                _vertices[edge . dst_vertex] . excess += edge . r_capacity;
+                edge . reverse_r_capacity += edge . r_capacity;
+                _residual_network[edge . dst_vertex][edge . reverse_edge_index] . r_capacity += edge . r_capacity;
+                _residual_network[edge . dst_vertex][edge . reverse_edge_index] . reverse_r_capacity -= edge . r_capacity;
+                edge . r_capacity = 0;
+            }
+            _push_cnt += _residual_network[_source] . size ();
+        }
+
+
         void find_max_flow_inner ( )
         {
             auto K = static_cast<U> ( std::ceil ( std::log2 ( _max_cap ) ));
@@ -189,7 +231,7 @@ namespace ahuja_orlin
 
         inline bool push ( const T vertex, const T label, const U delta ) noexcept
         {
-            for ( auto & edge : _residual_network[vertex] )
+            for ( auto && edge : _residual_network[vertex] )
             {
                 if ( edge . r_capacity > 0 && label == _vertices[edge . dst_vertex] . label + 1 )
                 {
@@ -255,13 +297,9 @@ namespace ahuja_orlin
 
         inline T calculate_new_label ( const T vertex ) noexcept
         {
-            T increase_to = _residual_network . size () - 1;
-            for ( auto & edge : _residual_network[vertex] )
-            {
-                if ( edge . r_capacity == 0 )
-                    continue;
-                increase_to = std::min ( increase_to, _vertices[edge . dst_vertex] . label );
-            }
+            const T increase_to = min_label::over_residual_arcs ( _residual_network[vertex], _vertices . get (),
+                                                                  &max_flow_instance::vertex::label,
+                                                                  static_cast<T> ( _residual_network . size () - 1 ) );
             _relabel_progress += _residual_network[vertex] . size ();
             return increase_to + 1;
         }
@@ -269,6 +307,11 @@ namespace ahuja_orlin
         void global_relabel ( const U delta ) noexcept
         {
             ++_global_relabel_cnt;
+            if ( _thread_count > 1 )
+            {
+                parallel_global_relabel ( delta );
+                return;
+            }
             auto not_reached = _residual_network . size ();
             for ( std::size_t i = 0; i < _residual_network . size (); ++i )
                 _vertices[i] . label = not_reached;
@@ -288,10 +331,12 @@ namespace ahuja_orlin
             while ( !_distance_q . empty () )
             {
                 auto current_elem = _distance_q . pop ();
+                prefetch::queue<PREFETCH_DISTANCE> ( _residual_network, _vertices . get (), 0, _distance_q . size (),
+                                                     [this] ( std::size_t k ) { return _distance_q[k] . first; } );
                 auto current_vertex = current_elem . first;
                 auto current_distance = current_elem . second;
                 _highest_vertex = std::max ( _highest_vertex, current_distance );
-                for ( auto & edge : _residual_network[current_vertex] )
+                for ( auto && edge : _residual_network[current_vertex] )
                 {
                     if ( edge . reverse_r_capacity > 0 && _vertices[edge . dst_vertex] . label == not_reached )
                     {
@@ -313,6 +358,41 @@ namespace ahuja_orlin
             }
         }
 
+        //every level fills the lists of its own label, so the levels are independent of each other
+        void parallel_global_relabel ( const U delta ) noexcept
+        {
+            for ( std::size_t i = 0; i <= _highest_vertex; ++i )
+            {
+                _labels[i] . active_vertices . clear ();
+                _labels[i] . inactive_vertices . clear ();
+            }
+            _levels . run ( _residual_network, _sink, static_cast<T> ( _residual_network . size () ), _vertices . get (),
+                            &max_flow_instance::vertex::label );
+
+            const std::size_t level_cnt = _levels . count ();
+            T lowest_active = _residual_network . size (), highest_active = 1;
+            #pragma omp parallel for schedule(dynamic, 1) reduction(min:lowest_active) reduction(max:highest_active) num_threads(static_cast<int> ( _thread_count ))
+            for ( std::size_t level = 1; level < level_cnt; ++level )
+            {
+                for ( auto * it = _levels . begin ( level ); it != _levels . end ( level ); ++it )
+                {
+                    if ( *it == _source )
+                        continue;
+                    auto * node = &_vertices[*it];
+                    if ( node -> excess > delta / 2 )
+                    {
+                        lowest_active = std::min ( lowest_active, static_cast<T> ( level ) );
+                        highest_active = static_cast<T> ( level );
+                        _labels[level] . active_vertices . push ( node );
+                    } else
+                        _labels[level] . inactive_vertices . push ( node );
+                }
+            }
+            _lowest_active = lowest_active;
+            _highest_active = highest_active;
+            _highest_vertex = std::max<T> ( 1, static_cast<T> ( level_cnt - 1 ) );
+        }
+
         void gap_relabel ( const T gap_height ) noexcept
         {
             ++_gap_cnt;
@@ -73,7 +73,7 @@ namespace dinic
             if ( current == _sink ) return flow;
             for ( ; _progress[current] < _residual_network[current] . size (); ++_progress[current] )
             {
-                auto & edge = _residual_network[current][_progress[current]];
+                auto && edge = _residual_network[current][_progress[current]];
                 if ( edge . r_capacity > 0 && _levels[edge . dst_vertex] == _levels[current] + 1 )
                 {
                     auto result_flow = augment_paths ( edge . dst_vertex, std::min ( flow, edge . r_capacity ) );
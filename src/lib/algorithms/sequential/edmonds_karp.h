@@ -15,7 +15,8 @@ namespace edmonds_karp
     class max_flow_instance
     {
         vector<vector<basic_edge<T, U>>> & _residual_network;
-        std::unique_ptr<basic_edge<T, U> * []> _parents;
+        std::unique_ptr<T[]> _parents;          //vertex from which the path reaches a vertex
+        std::unique_ptr<T[]> _parent_arcs;      //index of that arc in the adjacency of the parent
         std::unique_ptr<bool[]> _visited;
         data_structures::queue<T> _q;
         T _source, _sink;
@@ -24,7 +25,8 @@ namespace edmonds_karp
         bool is_set = false;
         max_flow_instance ( vector<vector<basic_edge<T, U>>> & graph, T source, T sink, size_t nthreads=1) :
                 _residual_network ( graph ),
-                _parents ( std::make_unique<basic_edge<T, U> * []> ( _residual_network . size () ) ),
+                _parents ( std::make_unique<T[]> ( _residual_network . size () ) ),
+                _parent_arcs ( std::make_unique<T[]> ( _residual_network . size () ) ),
                 _visited ( std::make_unique<bool[]> ( _residual_network . size () ) ),
                 _q ( data_structures::queue<T> ( _residual_network . size () ) ),
                 _source ( source ), _sink ( sink )
@@ -48,16 +50,17 @@ namespace edmonds_karp
             auto flow = std::numeric_limits<U>::max ();
             while ( current != _source )
             {
-                flow = std::min ( _parents[current] -> r_capacity, flow );
-                current = _residual_network[_parents[current] -> dst_vertex][_parents[current] -> reverse_edge_index] . dst_vertex;
+                flow = std::min ( _residual_network[_parents[current]][_parent_arcs[current]] . r_capacity, flow );
+                current = _parents[current];
             }
             //update capacities
             current = _sink;
             while ( current != _source )
             {
-                _parents[current] -> r_capacity -= flow;
-                _residual_network[_parents[current] -> dst_vertex][_parents[current] -> reverse_edge_index] . r_capacity += flow;
-                current = _residual_network[_parents[current] -> dst_vertex][_parents[current] -> reverse_edge_index] . dst_vertex;
+                auto && edge = _residual_network[_parents[current]][_parent_arcs[current]];
+                edge . r_capacity -= flow;
+                _residual_network[edge . dst_vertex][edge . reverse_edge_index] . r_capacity += flow;
+                current = _parents[current];
             }
             return flow;
         }
@@ -76,12 +79,15 @@ namespace edmonds_karp
                 if ( current == _sink )
                     return get_minimal_capacity_and_adjust_flow ();
 
-                for ( auto & edge : _residual_network[current] )
+                auto && edges = _residual_network[current];
+                for ( std::size_t i = 0; i < edges . size (); ++i )
                 {
+                    auto && edge = edges[i];
                     if ( edge . r_capacity > 0 && !_visited[edge . dst_vertex] )
                     {
                         _visited[edge . dst_vertex] = true;
-                        _parents[edge . dst_vertex] = &edge;
+                        _parents[edge . dst_vertex] = current;
+                        _parent_arcs[edge . dst_vertex] = i;
                         _q . push ( edge . dst_vertex );
                     }
                 }
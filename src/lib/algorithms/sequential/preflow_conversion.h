@@ -0,0 +1,141 @@
+/*
+ * Conversion of a maximum preflow into a maximum flow, the second phase of the push-relabel instances. The excess left
+ * at the vertices which cannot reach the sink is returned to the source along the arcs carrying flow into them. A
+ * depth first search from these vertices backwards over the arcs carrying flow cancels the flow cycles it meets, which
+ * leaves the arcs it visits acyclic, and the excess is then returned in reverse topological order, so every arc is
+ * scanned a constant number of times apart from the cycles cancelled. Only the part of the network the excess came
+ * through is visited, the flow reaching the sink is left as it is.
+ */
+
+#ifndef MAXFLOW_PREFLOW_CONVERSION_H
+#define MAXFLOW_PREFLOW_CONVERSION_H
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <type_traits>
+#include "../../common_types.h"
+
+namespace preflow_conversion
+{
+    //the arc at position arc carries the flow capacity_of ( arc ) - r_capacity from its head into its tail
+    template <typename network, typename capacity_fn>
+    auto inflow ( const network & graph, std::size_t arc, capacity_fn & capacity_of )
+    {
+        const auto capacity = capacity_of ( arc );
+        const auto r_capacity = graph . arc ( arc ) . r_capacity;
+        return r_capacity > capacity ? r_capacity - capacity : decltype ( r_capacity ) { 0 };
+    }
+
+    //moves amount of the flow into the tail of the arc at position arc back to its head
+    template <typename network, typename U>
+    void cancel ( network & graph, std::size_t arc, U amount )
+    {
+        auto && edge = graph . arc ( arc );
+        auto && reverse_edge = graph . arc ( graph . offset ( edge . dst_vertex ) + edge . reverse_edge_index );
+        edge . r_capacity -= amount;
+        edge . reverse_r_capacity += amount;
+        reverse_edge . r_capacity += amount;
+        reverse_edge . reverse_r_capacity -= amount;
+    }
+
+    //excess ( v ) is a reference to the excess of v and capacity_of ( arc ) the capacity of the arc with index arc,
+    //the excess of every vertex but source and sink is zero afterwards
+    template <typename network, typename T, typename excess_fn, typename capacity_fn>
+    void preflow_to_flow ( network & graph, T source, T sink, excess_fn && excess, capacity_fn && capacity_of )
+    {
+        using U = std::remove_reference_t<decltype ( excess ( source ) )>;
+        //a vertex on the stack with the flow on its current arc, which leads to the next vertex on the stack
+        struct entry
+        {
+            T vertex;
+            U flow;
+        };
+        enum : uint8_t { white, grey, black };
+        const std::size_t n = graph . size ();
+        std::vector<uint8_t> color ( n, white );
+        std::vector<std::size_t> current ( n ), position ( n );
+        std::vector<entry> stack;
+        std::vector<T> order;
+        color[source] = color[sink] = black;
+        //the arcs before current[v] carry no flow into v or come from finished vertices, which stays so as flow is
+        //only ever cancelled, so they are not scanned again when v is searched from again after a cycle
+        for ( std::size_t v = 0; v < n; ++v )
+            current[v] = graph . offset ( v );
+
+        for ( std::size_t root = 0; root < n; ++root )
+        {
+            if ( color[root] != white || excess ( root ) == 0 )
+                continue;
+
+            color[root] = grey;
+            position[root] = 0;
+            stack . push_back ( entry { static_cast<T> ( root ), 0 } );
+            while ( !stack . empty () )
+            {
+                const T vertex = stack . back () . vertex;
+                auto & arc = current[vertex];
+                U flow = 0;
+                for ( ; arc < graph . offset ( vertex + 1 ); ++arc )
+                    if ( color[graph . arc ( arc ) . dst_vertex] != black && ( flow = inflow ( graph, arc, capacity_of ) ) > 0 )
+                        break;
+
+                if ( arc == graph . offset ( vertex + 1 ) )
+                {
+                    color[vertex] = black;
+                    order . push_back ( vertex );
+                    stack . pop_back ();
+                    continue;
+                }
+
+                const T next = graph . arc ( arc ) . dst_vertex;
+                stack . back () . flow = flow;
+                if ( color[next] == white )
+                {
+                    color[next] = grey;
+                    position[next] = stack . size ();
+                    stack . push_back ( entry { next, 0 } );
+                    continue;
+                }
+
+                //next is on the stack, the arcs followed from next on close a cycle of flow
+                const std::size_t first = position[next];
+                U amount = flow;
+                for ( auto i = first; i < stack . size (); ++i )
+                    amount = std::min ( amount, stack[i] . flow );
+                for ( auto i = first; i < stack . size (); ++i )
+                {
+                    cancel ( graph, current[stack[i] . vertex], amount );
+                    stack[i] . flow -= amount;
+                }
+
+                //resume from the first vertex whose arc on the cycle carries no more flow
+                auto i = first;
+                while ( stack[i] . flow > 0 )
+                    ++i;
+                for ( auto j = i + 1; j < stack . size (); ++j )
+                    color[stack[j] . vertex] = white;
+                stack . resize ( i + 1 );
+            }
+        }
+
+        //every vertex comes after the vertices it receives flow from, the excess is passed on to them last to first
+        for ( auto it = order . rbegin (); it != order . rend (); ++it )
+        {
+            const T vertex = *it;
+            for ( auto arc = graph . offset ( vertex ); excess ( vertex ) > 0 && arc < graph . offset ( vertex + 1 ); ++arc )
+            {
+                const auto amount = std::min ( excess ( vertex ), inflow ( graph, arc, capacity_of ) );
+                if ( amount == 0 )
+                    continue;
+                const T next = graph . arc ( arc ) . dst_vertex;
+                cancel ( graph, arc, amount );
+                excess ( vertex ) -= amount;
+                if ( next != source )
+                    excess ( next ) += amount;
+            }
+        }
+    }
+}
+
+#endif //MAXFLOW_PREFLOW_CONVERSION_H
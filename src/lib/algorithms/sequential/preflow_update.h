@@ -0,0 +1,144 @@
+/*
+ * Capacity updates of a network holding a maximum preflow, for push-relabel instances which resume instead of starting
+ * over. Raising a capacity only adds residual capacity. Lowering it below the flow on the arc cancels the surplus: its
+ * tail keeps the flow as excess, and the flow its head can no longer send on is cancelled along paths of arcs carrying
+ * flow, which end at the sink, the source or a vertex with excess. The work is proportional to the part of the network
+ * the cancelled flow passes through. The labels are left as they are, the instance recomputes them when it resumes.
+ */
+
+#ifndef MAXFLOW_PREFLOW_UPDATE_H
+#define MAXFLOW_PREFLOW_UPDATE_H
+
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+#include "../../common_types.h"
+
+namespace preflow_update
+{
+    template <typename T, typename U>
+    class arc_updater
+    {
+        std::vector<uint8_t> _visited;
+        std::vector<T> _touched;
+        std::vector<std::pair<T, std::size_t>> _stack;
+        std::vector<std::size_t> _path;
+    public:
+        //changes the capacity of the arc at position idx of vertex from capacity to new_capacity, excess ( v ) is a
+        //reference to the excess of v and capacity_of ( arc ) the capacity of the arc with index arc after the change
+        template <typename network, typename excess_fn, typename capacity_fn>
+        void operator () ( network & graph, T vertex, std::size_t idx, U capacity, U new_capacity, T source, T sink,
+                           excess_fn && excess, capacity_fn && capacity_of )
+        {
+            auto && edge = graph . arc ( graph . offset ( vertex ) + idx );
+            auto && reverse_edge = graph . arc ( graph . offset ( edge . dst_vertex ) + edge . reverse_edge_index );
+            if ( new_capacity >= capacity || edge . r_capacity >= capacity - new_capacity )
+            {
+                edge . r_capacity = new_capacity >= capacity ? edge . r_capacity + ( new_capacity - capacity )
+                                                             : edge . r_capacity - ( capacity - new_capacity );
+                reverse_edge . reverse_r_capacity = edge . r_capacity;
+                return;
+            }
+
+            const T head = edge . dst_vertex;
+            const U surplus = capacity - new_capacity - edge . r_capacity;
+            edge . r_capacity = 0;
+            edge . reverse_r_capacity -= surplus;
+            reverse_edge . r_capacity -= surplus;
+            reverse_edge . reverse_r_capacity = 0;
+            if ( vertex != source )
+                excess ( vertex ) += surplus;
+
+            if ( head == sink )
+                excess ( head ) -= surplus;
+            else if ( head == source )
+                excess ( head ) -= std::min ( excess ( head ), surplus );
+            else if ( excess ( head ) >= surplus )
+                excess ( head ) -= surplus;
+            else
+            {
+                const U deficit = surplus - excess ( head );
+                excess ( head ) = 0;
+                cancel_outflow ( graph, head, deficit, source, sink, excess, capacity_of );
+            }
+        }
+
+    private:
+        template <typename network, typename excess_fn, typename capacity_fn>
+        void cancel_outflow ( network & graph, T vertex, U amount, T source, T sink, excess_fn & excess,
+                              capacity_fn & capacity_of )
+        {
+            if ( _visited . size () < graph . size () )
+                _visited . assign ( graph . size (), 0 );
+
+            while ( amount > 0 )
+            {
+                T target = find_path ( graph, vertex, source, sink, excess, capacity_of );
+                if ( _path . empty () )
+                    break;
+
+                U flow = amount;
+                for ( auto arc : _path )
+                    flow = std::min ( flow, capacity_of ( arc ) - graph . arc ( arc ) . r_capacity );
+                if ( target != sink && target != source )
+                    flow = std::min ( flow, excess ( target ) );
+
+                for ( auto arc : _path )
+                {
+                    auto && edge = graph . arc ( arc );
+                    auto && reverse_edge = graph . arc ( graph . offset ( edge . dst_vertex ) + edge . reverse_edge_index );
+                    edge . r_capacity += flow;
+                    edge . reverse_r_capacity -= flow;
+                    reverse_edge . r_capacity -= flow;
+                    reverse_edge . reverse_r_capacity += flow;
+                }
+                excess ( target ) -= target == source ? std::min ( excess ( target ), flow ) : flow;
+                amount -= flow;
+            }
+        }
+
+        //depth first search from vertex over arcs carrying flow, the arcs of the path found are left in _path
+        template <typename network, typename excess_fn, typename capacity_fn>
+        T find_path ( network & graph, T vertex, T source, T sink, excess_fn & excess, capacity_fn & capacity_of )
+        {
+            for ( auto v : _touched )
+                _visited[v] = 0;
+            _touched . clear ();
+            _path . clear ();
+            _stack . clear ();
+            _stack . emplace_back ( vertex, graph . offset ( vertex ) );
+            _visited[vertex] = 1;
+            _touched . push_back ( vertex );
+
+            for ( ;; )
+            {
+                const T current = _stack . back () . first;
+                const std::size_t arc = _stack . back () . second++;
+                if ( arc == graph . offset ( current + 1 ) )
+                {
+                    //a path exists as long as the flow to cancel does not exceed the flow leaving vertex
+                    _stack . pop_back ();
+                    if ( _path . empty () )
+                        return vertex;
+                    _path . pop_back ();
+                    continue;
+                }
+
+                auto && edge = graph . arc ( arc );
+                const T next = edge . dst_vertex;
+                if ( _visited[next] || capacity_of ( arc ) <= edge . r_capacity )
+                    continue;
+
+                _path . push_back ( arc );
+                if ( next == sink || next == source || excess ( next ) > 0 )
+                    return next;
+                _visited[next] = 1;
+                _touched . push_back ( next );
+                _stack . emplace_back ( next, graph . offset ( next ) );
+            }
+        }
+    };
+}
+
+#endif //MAXFLOW_PREFLOW_UPDATE_H
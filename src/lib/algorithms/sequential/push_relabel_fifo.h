@@ -1,11 +1,16 @@
 /*
- * Push-relabel, FIFO active vertex selection.
+ * Push-relabel, FIFO active vertex selection. Given more than one thread, the global relabels run as a parallel
+ * breadth first search, while the vertices are discharged by a single thread.
  */
 
 #ifndef MAXFLOW_PUSH_RELABEL_FIFO_H
 #define MAXFLOW_PUSH_RELABEL_FIFO_H
 
 #include "../../common_types.h"
+#include "../../prefetch.h"
+#include "../../min_label.h"
+#include "preflow_conversion.h"
+#include "../parallel/parallel_bfs.h"
 #include "../../data_structures/queue.h"
 #include "../../data_structures/linked_list.h"
 #include "../../data_structures/circular_queue.h"
@@ -29,7 +34,9 @@ namespace push_relabel_fifo
         std::unique_ptr<vertex[]> _vertices;
         data_structures::circular_queue<T> _q;
         data_structures::queue<pair> _distance_q;
+        parallel_bfs::levels<T> _levels;
         T _source, _sink, _relabel_progress { 0 }, _relabel_threshold;
+        const std::size_t _thread_count;
 
         //statistics
         uint64_t _push_cnt { 0 }, _relabel_cnt { 0 }, _global_relabel_cnt { 0 };
@@ -40,7 +47,8 @@ namespace push_relabel_fifo
                 _vertices ( std::make_unique<vertex[]> ( _residual_network . size () ) ),
                 _q ( data_structures::circular_queue<T> { _residual_network . size () } ),
                 _distance_q ( data_structures::queue<pair> { _residual_network . size () } ),
-                _source ( source ), _sink ( sink )
+                _levels ( _residual_network . size (), nthread ),
+                _source ( source ), _sink ( sink ), _thread_count ( nthread )
         {
             init ();
         }
@@ -56,11 +64,13 @@ namespace push_relabel_fifo
             return _vertices[_sink] . excess;
         }
 
-        void preflow_to_flow ( )
+        //returns the excess left by find_max_flow to the source, capacity_of ( arc ) is the capacity of the arc with
+        //index arc, see preflow_conversion
+        template <typename capacity_fn>
+        void preflow_to_flow ( capacity_fn && capacity_of )
         {
-            std::swap ( _source, _sink );
-            find_max_flow_inner ();
-            std::swap ( _source, _sink );
+            preflow_conversion::preflow_to_flow ( _residual_network, _source, _sink,
+                                                  [this] ( T v ) -> U & { return _vertices[v] . excess; }, capacity_of );
             #ifdef DEBUG
             for ( std::size_t i = 0; i < _residual_network . size(); ++i )
                 if ( i != _source && i != _sink )
@@ -76,12 +86,13 @@ namespace push_relabel_fifo
 
     private:
         static constexpr T ALPHA = 6, BETA = 12;
+        static constexpr std::size_t PREFETCH_DISTANCE = prefetch::default_distance;
         static constexpr double GLOBAL_RELABEL_FREQ = 0.5;
 
 
         void init ( )
         {
-            for ( auto & edge : _residual_network[_source] )
+            for ( auto && edge : _residual_network[_source] )
             {
                 if ( edge . r_capacity > 0 )
                 {
@@ -95,8 +106,8 @@ namespace push_relabel_fifo
             }
 
             T m = 0;
-            for ( auto & vec : _residual_network )
-                m += vec . size ();
+            for ( std::size_t i = 0; i < _residual_network . size (); ++i )
+                m += _residual_network[i] . size ();
             _relabel_threshold = _residual_network . size () * ALPHA + m / 2;
         }
 
@@ -109,6 +120,8 @@ namespace push_relabel_fifo
                     return;
 
                 auto vertex = _q . pop ();
+                prefetch::queue<PREFETCH_DISTANCE> ( _residual_network, _vertices . get (), 0, _q . size (),
+                                                     [this] ( std::size_t k ) { return _q[k]; } );
                 auto label = _vertices[vertex] . label;
                 discharge ( vertex, label );
 
@@ -136,7 +149,7 @@ namespace push_relabel_fifo
         bool push ( const T vertex, const T label )
         {
             const auto target_label = label - 1;
-            for ( auto & edge : _residual_network[vertex] )
+            for ( auto && edge : _residual_network[vertex] )
             {
                 if ( edge . r_capacity > 0 && _vertices[edge . dst_vertex] . label == target_label )
                 {
@@ -169,13 +182,9 @@ namespace push_relabel_fifo
 
         T calculate_new_label ( const T vertex )
         {
-            T increase_to = _residual_network . size () - 1;
-            for ( auto & edge : _residual_network[vertex] )
-            {
-                if ( edge . r_capacity == 0 )
-                    continue;
-                increase_to = std::min ( increase_to, _vertices[edge . dst_vertex] . label );
-            }
+            const T increase_to = min_label::over_residual_arcs ( _residual_network[vertex], _vertices . get (),
+                                                                  &max_flow_instance::vertex::label,
+                                                                  static_cast<T> ( _residual_network . size () - 1 ) );
             _relabel_progress += _residual_network[vertex] . size ();
             return increase_to + 1;
         }
@@ -184,6 +193,11 @@ namespace push_relabel_fifo
         void global_relabel ( )
         {
             ++_global_relabel_cnt;
+            if ( _thread_count > 1 )
+            {
+                parallel_global_relabel ();
+                return;
+            }
             auto not_reached = _residual_network . size ();
 
             for ( std::size_t i = 0; i < _residual_network . size (); ++i )
@@ -197,20 +211,32 @@ namespace push_relabel_fifo
             while ( !_distance_q . empty () )
             {
                 auto current_elem = _distance_q . pop ();
+                prefetch::queue<PREFETCH_DISTANCE> ( _residual_network, _vertices . get (), 0, _distance_q . size (),
+                                                     [this] ( std::size_t k ) { return _distance_q[k] . first; } );
                 auto current_vertex = current_elem . first;
                 auto current_distance = current_elem . second;
-                for ( auto & edge : _residual_network[current_vertex] )
+                for ( auto && edge : _residual_network[current_vertex] )
                 {
                     if ( edge . reverse_r_capacity > 0 && _vertices[edge . dst_vertex] . label == not_reached )
                     {
                         _vertices[edge . dst_vertex] . label = current_distance + 1;
                         _distance_q . push ( std::make_pair ( edge . dst_vertex, current_distance + 1 ) );
-                        if ( _vertices[edge . dst_vertex] . excess > 0 )
+                        if ( _vertices[edge . dst_vertex] . excess > 0 && edge . dst_vertex != _source )
                             _q . push ( edge . dst_vertex );
                     }
                 }
             }
         }
+
+        void parallel_global_relabel ( )
+        {
+            _levels . run ( _residual_network, _sink, static_cast<T> ( _residual_network . size () ), _vertices . get (),
+                            &max_flow_instance::vertex::label );
+            _q . reset ();
+            for ( auto * it = _levels . end ( 0 ); it != _levels . end (); ++it )
+                if ( _vertices[*it] . excess > 0 && *it != _source )
+                    _q . push ( *it );
+        }
     };
 }
 
@@ -0,0 +1,101 @@
+/*
+ * Vertex orders which renumber a network for locality of the per-vertex data the instances look up through arcs. A
+ * breadth first order from the sink keeps the vertices the global relabels and pushes reach together close in memory,
+ * the reverse Cuthill-McKee order narrows the band of the adjacency matrix and the degree order packs the vertices with
+ * the most arcs, the ones looked up most often, at the front. Every order is a vector order with order[i] the vertex
+ * numbered i after renumbering.
+ */
+
+#ifndef MAXFLOW_VERTEX_ORDER_H
+#define MAXFLOW_VERTEX_ORDER_H
+
+#include <vector>
+#include <cstdint>
+#include <numeric>
+#include <algorithm>
+#include "../../common_types.h"
+
+namespace vertex_order
+{
+    //appends the vertices reached from root which are not visited yet in breadth first order, the neighbours of every
+    //vertex are visited as arranged by arrange ( first, last )
+    template <typename network, typename T, typename arrange_fn>
+    void breadth_first ( const network & graph, T root, std::vector<uint8_t> & visited, std::vector<T> & order,
+                         arrange_fn && arrange )
+    {
+        auto head = order . size ();
+        visited[root] = 1;
+        order . push_back ( root );
+        for ( ; head < order . size (); ++head )
+        {
+            const T vertex = order[head];
+            const auto first = order . size ();
+            for ( auto arc = graph . offset ( vertex ); arc < graph . offset ( vertex + 1 ); ++arc )
+            {
+                const T next = graph . arc ( arc ) . dst_vertex;
+                if ( !visited[next] )
+                {
+                    visited[next] = 1;
+                    order . push_back ( next );
+                }
+            }
+            arrange ( order . begin () + first, order . end () );
+        }
+    }
+
+    //breadth first from root, the vertices it does not reach follow in breadth first order from the first of them
+    template <typename T, typename network>
+    std::vector<T> bfs ( const network & graph, T root )
+    {
+        const std::size_t n = graph . size ();
+        std::vector<uint8_t> visited ( n, 0 );
+        std::vector<T> order;
+        order . reserve ( n );
+        auto keep = [] ( auto, auto ) { };
+        breadth_first ( graph, root, visited, order, keep );
+        for ( std::size_t v = 0; v < n; ++v )
+            if ( !visited[v] )
+                breadth_first ( graph, static_cast<T> ( v ), visited, order, keep );
+        return order;
+    }
+
+    //breadth first with the neighbours visited by increasing degree, each component from its vertex of lowest degree
+    //unless root is in it, reversed
+    template <typename T, typename network>
+    std::vector<T> rcm ( const network & graph, T root )
+    {
+        const std::size_t n = graph . size ();
+        auto degree = [&graph] ( T v ) { return graph . offset ( v + 1 ) - graph . offset ( v ); };
+        std::vector<T> by_degree ( n );
+        std::iota ( by_degree . begin (), by_degree . end (), T { 0 } );
+        std::stable_sort ( by_degree . begin (), by_degree . end (), [&] ( T x, T y ) { return degree ( x ) < degree ( y ); } );
+
+        std::vector<uint8_t> visited ( n, 0 );
+        std::vector<T> order;
+        order . reserve ( n );
+        auto by_increasing_degree = [&] ( auto first, auto last )
+        {
+            std::stable_sort ( first, last, [&] ( T x, T y ) { return degree ( x ) < degree ( y ); } );
+        };
+        breadth_first ( graph, root, visited, order, by_increasing_degree );
+        for ( auto v : by_degree )
+            if ( !visited[v] )
+                breadth_first ( graph, v, visited, order, by_increasing_degree );
+        std::reverse ( order . begin (), order . end () );
+        return order;
+    }
+
+    //by decreasing degree, vertices of equal degree keep their order
+    template <typename T, typename network>
+    std::vector<T> degree ( const network & graph )
+    {
+        std::vector<T> order ( graph . size () );
+        std::iota ( order . begin (), order . end (), T { 0 } );
+        std::stable_sort ( order . begin (), order . end (), [&graph] ( T x, T y ) {
+            return graph . offset ( x + 1 ) - graph . offset ( x ) > graph . offset ( y + 1 ) - graph . offset ( y );
+        } );
+        return order;
+    }
+}
+
+#endif //MAXFLOW_VERTEX_ORDER_H
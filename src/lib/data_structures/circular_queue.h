@@ -53,6 +53,13 @@ namespace data_structures
 
         bool empty ( ) const noexcept
         { return _front == _back && !_flag; }
+
+        std::size_t size ( ) const noexcept
+        { return _back > _front || ( _back == _front && !_flag ) ? _back - _front : _back + _size - _front; }
+
+        //the element idx places behind the front, idx < size ()
+        const T & operator [] ( std::size_t idx ) const noexcept
+        { return _data[_front + idx < _size ? _front + idx : _front + idx - _size]; }
     };
 }
 
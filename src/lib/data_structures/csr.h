@@ -0,0 +1,106 @@
+/*
+ * Residual network stored in compressed sparse row format: one offsets array and one contiguous array of arcs.
+ * It is a drop-in replacement for vector<vector<edge>> in the max flow instances - csr<csr<edge>> is the whole
+ * network and csr<edge> is the range of arcs leaving a single vertex. The arrays are either owned by the network or
+ * kept alive by it, e.g. when they point into a mapped snapshot file.
+ */
+
+#ifndef MAXFLOW_CSR_H
+#define MAXFLOW_CSR_H
+
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+namespace data_structures
+{
+    template <typename edge>
+    class csr
+    {
+        edge * _begin { nullptr };
+        edge * _end { nullptr };
+    public:
+        csr ( ) = default;
+
+        csr ( edge * begin, edge * end ) noexcept : _begin ( begin ), _end ( end )
+        { }
+
+        edge * begin ( ) const noexcept
+        { return _begin; }
+
+        edge * end ( ) const noexcept
+        { return _end; }
+
+        std::size_t size ( ) const noexcept
+        { return _end - _begin; }
+
+        edge & operator [] ( std::size_t idx ) const noexcept
+        { return _begin[idx]; }
+    };
+
+
+    template <typename edge>
+    class csr<csr<edge>>
+    {
+        std::shared_ptr<std::size_t[]> _offsets { nullptr };
+        std::shared_ptr<edge[]> _arcs { nullptr };
+        std::size_t _vertex_cnt { 0 };
+    public:
+        using edge_type = edge;
+        static constexpr uint32_t arc_layout = 0;
+
+        csr ( ) = default;
+
+        //offsets hold vertex_cnt + 1 entries, arcs are left uninitialized so that they can be filled in parallel
+        csr ( std::shared_ptr<std::size_t[]> offsets, std::size_t vertex_cnt ) :
+                _offsets ( std::move ( offsets ) ),
+                _arcs ( new edge[_offsets[vertex_cnt]] ),
+                _vertex_cnt ( vertex_cnt )
+        { }
+
+        //uses existing arrays, which may share ownership of a larger buffer through the aliasing constructor
+        csr ( std::shared_ptr<std::size_t[]> offsets, std::shared_ptr<void> storage, std::size_t vertex_cnt ) noexcept :
+                _offsets ( std::move ( offsets ) ),
+                _arcs ( storage, static_cast<edge *> ( storage . get () ) ),
+                _vertex_cnt ( vertex_cnt )
+        { }
+
+        csr ( csr && other ) noexcept = default;
+
+        csr & operator = ( csr && other ) noexcept = default;
+
+        csr ( const csr & other ) = delete;
+
+        csr & operator = ( const csr & other ) = delete;
+
+        static std::size_t storage_bytes ( std::size_t arc_cnt ) noexcept
+        { return arc_cnt * sizeof ( edge ); }
+
+        std::size_t size ( ) const noexcept
+        { return _vertex_cnt; }
+
+        std::size_t arc_count ( ) const noexcept
+        { return _offsets[_vertex_cnt]; }
+
+        std::size_t offset ( std::size_t vertex ) const noexcept
+        { return _offsets[vertex]; }
+
+        const std::size_t * offsets ( ) const noexcept
+        { return _offsets . get (); }
+
+        //networks with the same topology can share the offsets
+        std::shared_ptr<std::size_t[]> shared_offsets ( ) const noexcept
+        { return _offsets; }
+
+        void * storage ( ) const noexcept
+        { return _arcs . get (); }
+
+        edge & arc ( std::size_t idx ) const noexcept
+        { return _arcs[idx]; }
+
+        csr<edge> operator [] ( std::size_t vertex ) const noexcept
+        { return csr<edge> ( _arcs . get () + _offsets[vertex], _arcs . get () + _offsets[vertex + 1] ); }
+    };
+}
+
+#endif //MAXFLOW_CSR_H
@@ -0,0 +1,247 @@
+/*
+ * Residual network of a 2D or 3D lattice which stores capacities only. Every pixel has an arc to each of its
+ * neighbours, one to the source and one to the sink, the source and the sink having an arc to every pixel; the heads
+ * and reverse arcs follow from the lattice by index arithmetic. The capacities are kept in one array per direction,
+ * and four more for the arcs between the pixels and the terminals, so a pixel takes directions + 4 capacities instead
+ * of the arcs of the csr networks with their heads and reverse indices.
+ *
+ * The directions of a neighbourhood are its offsets in {-1, 0, 1}^2, or ^3, in lexicographic order (z, y, x), so that
+ * direction directions - 1 - k is opposite to k. Pixels are numbered in C order of their (z, y, x), the source and
+ * the sink after them. Arcs which would leave the lattice are kept with no capacity, so that the arcs of a pixel can be
+ * addressed by their index: those whose neighbour is outside the pixels are self loops, the others have a reverse
+ * arc which leaves the lattice as well, and neither ever gets any capacity.
+ *
+ * The arcs are accessed through proxies, as those of soa_csr, whose cached reverse_r_capacity reads the capacity of
+ * the reverse arc and ignores writes: the instances update the capacity of the reverse arc along with it, so both
+ * always agree, which is also why the asynchronous instance, which updates them atomically, does not run on it.
+ */
+
+#ifndef MAXFLOW_GRID_H
+#define MAXFLOW_GRID_H
+
+#include <array>
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include "../common_types.h"
+
+namespace data_structures
+{
+    //the cached capacity of the reverse arc, read from the reverse arc itself
+    template <typename U>
+    struct reverse_capacity
+    {
+        const U & value;
+
+        operator U ( ) const noexcept
+        { return value; }
+
+        const reverse_capacity & operator += ( U ) const noexcept
+        { return *this; }
+
+        const reverse_capacity & operator -= ( U ) const noexcept
+        { return *this; }
+    };
+
+    template <typename edge>
+    struct grid_arc;
+
+    template <typename T, typename U>
+    struct grid_arc<basic_edge<T, U>>
+    {
+        T dst_vertex;
+        T reverse_edge_index;
+        U & r_capacity;
+
+        grid_arc ( T dst_vertex, T reverse_edge_index, U & r_capacity, const U & ) noexcept
+                : dst_vertex ( dst_vertex ), reverse_edge_index ( reverse_edge_index ), r_capacity ( r_capacity )
+        { }
+    };
+
+    template <typename T, typename U>
+    struct grid_arc<cached_edge<T, U>>
+    {
+        T dst_vertex;
+        T reverse_edge_index;
+        U & r_capacity;
+        reverse_capacity<U> reverse_r_capacity;
+
+        grid_arc ( T dst_vertex, T reverse_edge_index, U & r_capacity, const U & reverse ) noexcept
+                : dst_vertex ( dst_vertex ), reverse_edge_index ( reverse_edge_index ), r_capacity ( r_capacity ),
+                  reverse_r_capacity { reverse }
+        { }
+    };
+
+    template <typename edge>
+    struct grid_shape;
+
+    //the lattice and its capacities, shared by the network and the arcs of its vertices
+    template <template <typename, typename> typename EDGE, typename T, typename U>
+    struct grid_shape<EDGE<T, U>>
+    {
+        std::size_t nx, ny, nz, pixel_cnt, direction_cnt;
+        std::vector<std::array<int, 3>> offsets;
+        std::vector<std::ptrdiff_t> steps;
+        std::unique_ptr<U[]> capacities;
+        const U zero { 0 };
+
+        grid_shape ( std::size_t nx, std::size_t ny, std::size_t nz, std::size_t neighbours )
+                : nx ( nx ), ny ( ny ), nz ( nz ), pixel_cnt ( nx * ny * nz ), direction_cnt ( neighbours ),
+                  offsets ( directions ( neighbours ) ),
+                  capacities ( std::make_unique<U[]> ( ( neighbours + 4 ) * pixel_cnt ) )
+        {
+            for ( auto && offset : offsets )
+                steps . push_back ( ( static_cast<std::ptrdiff_t> ( offset[0] ) * static_cast<std::ptrdiff_t> ( ny )
+                                      + offset[1] ) * static_cast<std::ptrdiff_t> ( nx ) + offset[2] );
+        }
+
+        //the offsets ( z, y, x ) of the directions of a neighbourhood of 4 or 8 pixels in 2D, 6 or 26 in 3D
+        static std::vector<std::array<int, 3>> directions ( std::size_t neighbours )
+        {
+            std::vector<std::array<int, 3>> offsets;
+            const int depth = neighbours == 6 || neighbours == 26;
+            for ( int z = -depth; z <= depth; ++z )
+                for ( int y = -1; y <= 1; ++y )
+                    for ( int x = -1; x <= 1; ++x )
+                    {
+                        const int norm = std::abs ( z ) + std::abs ( y ) + std::abs ( x );
+                        if ( norm > 0 && ( norm == 1 || neighbours == 8 || neighbours == 26 ) )
+                            offsets . push_back ( { z, y, x } );
+                    }
+            return offsets;
+        }
+
+        //the capacities of the arcs of the pixels in direction k, then of the arcs to the source and to the sink,
+        //and of the arcs from the source and from the sink
+        U * direction ( std::size_t k ) const noexcept
+        { return capacities . get () + k * pixel_cnt; }
+
+        U * to_source ( ) const noexcept
+        { return direction ( direction_cnt ); }
+
+        U * to_sink ( ) const noexcept
+        { return direction ( direction_cnt + 1 ); }
+
+        U * from_source ( ) const noexcept
+        { return direction ( direction_cnt + 2 ); }
+
+        U * from_sink ( ) const noexcept
+        { return direction ( direction_cnt + 3 ); }
+
+        std::size_t degree ( T vertex ) const noexcept
+        { return vertex < pixel_cnt ? direction_cnt + 2 : pixel_cnt; }
+
+        grid_arc<EDGE<T, U>> arc ( T vertex, T idx ) const noexcept
+        {
+            const auto source = static_cast<T> ( pixel_cnt ), sink = static_cast<T> ( pixel_cnt + 1 );
+            if ( vertex == source )
+                return { idx, static_cast<T> ( direction_cnt ), from_source ()[idx], to_source ()[idx] };
+            if ( vertex == sink )
+                return { idx, static_cast<T> ( direction_cnt + 1 ), from_sink ()[idx], to_sink ()[idx] };
+            if ( idx == direction_cnt )
+                return { source, vertex, to_source ()[vertex], from_source ()[vertex] };
+            if ( idx == direction_cnt + 1 )
+                return { sink, vertex, to_sink ()[vertex], from_sink ()[vertex] };
+
+            const auto head = static_cast<std::ptrdiff_t> ( vertex ) + steps[idx];
+            if ( head < 0 || head >= static_cast<std::ptrdiff_t> ( pixel_cnt ) )
+                return { vertex, idx, direction ( idx )[vertex], zero };
+            const auto reverse = static_cast<T> ( direction_cnt - 1 - idx );
+            return { static_cast<T> ( head ), reverse, direction ( idx )[vertex], direction ( reverse )[head] };
+        }
+    };
+
+
+    template <typename edge>
+    class grid
+    {
+        const grid_shape<edge> * _shape { nullptr };
+        std::size_t _vertex { 0 };
+    public:
+        class iterator
+        {
+            const grid_shape<edge> * _shape;
+            std::size_t _vertex, _idx;
+        public:
+            iterator ( const grid_shape<edge> * shape, std::size_t vertex, std::size_t idx ) noexcept
+                    : _shape ( shape ), _vertex ( vertex ), _idx ( idx )
+            { }
+
+            grid_arc<edge> operator * ( ) const noexcept
+            { return _shape -> arc ( _vertex, _idx ); }
+
+            iterator & operator ++ ( ) noexcept
+            {
+                ++_idx;
+                return *this;
+            }
+
+            bool operator != ( const iterator & other ) const noexcept
+            { return _idx != other . _idx; }
+        };
+
+        grid ( ) = default;
+
+        grid ( const grid_shape<edge> * shape, std::size_t vertex ) noexcept : _shape ( shape ), _vertex ( vertex )
+        { }
+
+        iterator begin ( ) const noexcept
+        { return iterator ( _shape, _vertex, 0 ); }
+
+        iterator end ( ) const noexcept
+        { return iterator ( _shape, _vertex, size () ); }
+
+        std::size_t size ( ) const noexcept
+        { return _shape -> degree ( _vertex ); }
+
+        grid_arc<edge> operator [] ( std::size_t idx ) const noexcept
+        { return _shape -> arc ( _vertex, idx ); }
+    };
+
+
+    template <typename edge>
+    class grid<grid<edge>>
+    {
+        std::unique_ptr<grid_shape<edge>> _shape;
+    public:
+        using edge_type = edge;
+
+        //a lattice of nz x ny x nx pixels with the given neighbourhood, see grid_shape::directions, and no capacities
+        grid ( std::size_t nx, std::size_t ny, std::size_t nz, std::size_t neighbours )
+                : _shape ( std::make_unique<grid_shape<edge>> ( nx, ny, nz, neighbours ) )
+        { }
+
+        grid ( grid && other ) noexcept = default;
+
+        grid & operator = ( grid && other ) noexcept = default;
+
+        grid ( const grid & other ) = delete;
+
+        grid & operator = ( const grid & other ) = delete;
+
+        std::size_t size ( ) const noexcept
+        { return _shape -> pixel_cnt + 2; }
+
+        std::size_t arc_count ( ) const noexcept
+        { return _shape -> pixel_cnt * ( _shape -> direction_cnt + 4 ); }
+
+        std::size_t pixel_count ( ) const noexcept
+        { return _shape -> pixel_cnt; }
+
+        std::size_t source ( ) const noexcept
+        { return _shape -> pixel_cnt; }
+
+        std::size_t sink ( ) const noexcept
+        { return _shape -> pixel_cnt + 1; }
+
+        const grid_shape<edge> & shape ( ) const noexcept
+        { return *_shape; }
+
+        grid<edge> operator [] ( std::size_t vertex ) const noexcept
+        { return grid<edge> ( _shape . get (), vertex ); }
+    };
+}
+
+#endif //MAXFLOW_GRID_H
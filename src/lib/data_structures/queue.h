@@ -40,6 +40,13 @@ namespace data_structures
         bool empty ( ) const noexcept
         { return _front == _back; }
 
+        std::size_t size ( ) const noexcept
+        { return _back - _front; }
+
+        //the element idx places behind the front
+        const T & operator [] ( std::size_t idx ) const noexcept
+        { return _data[_front + idx]; }
+
         void reset ( ) noexcept
         { _front = _back = 0; }
     };
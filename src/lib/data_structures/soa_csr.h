@@ -0,0 +1,242 @@
+/*
+ * Residual network in compressed sparse row format with the arcs stored as a structure of arrays: one array per edge
+ * member, so that a scan which reads only some of the members touches only their bytes. Arcs are accessed through
+ * proxies with reference members named like the members of the edge, so the max flow instances compile unchanged
+ * against csr and soa_csr as long as they bind arcs with auto &&.
+ */
+
+#ifndef MAXFLOW_SOA_CSR_H
+#define MAXFLOW_SOA_CSR_H
+
+#include <new>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include "../common_types.h"
+
+namespace data_structures
+{
+    constexpr std::size_t soa_alignment = 64;
+
+    inline std::size_t soa_array_bytes ( std::size_t bytes ) noexcept
+    {
+        return ( bytes + soa_alignment - 1 ) / soa_alignment * soa_alignment;
+    }
+
+    //pointers to the member arrays of the arcs, fields + idx points to the arrays of the arcs from idx on
+    template <typename edge>
+    struct soa_fields;
+
+    template <typename T, typename U>
+    struct soa_fields<basic_edge<T, U>>
+    {
+        T * dst_vertex;
+        T * reverse_edge_index;
+        U * r_capacity;
+
+        struct reference
+        {
+            T & dst_vertex;
+            T & reverse_edge_index;
+            U & r_capacity;
+
+            const reference & operator = ( const basic_edge<T, U> & edge ) const noexcept
+            {
+                dst_vertex = edge . dst_vertex;
+                reverse_edge_index = edge . reverse_edge_index;
+                r_capacity = edge . r_capacity;
+                return *this;
+            }
+        };
+
+        static std::size_t storage_bytes ( std::size_t arc_cnt ) noexcept
+        {
+            return 2 * soa_array_bytes ( arc_cnt * sizeof ( T ) ) + soa_array_bytes ( arc_cnt * sizeof ( U ) );
+        }
+
+        static soa_fields in ( void * storage, std::size_t arc_cnt ) noexcept
+        {
+            auto * bytes = static_cast<char *> ( storage );
+            const auto vertices = soa_array_bytes ( arc_cnt * sizeof ( T ) );
+            return soa_fields { reinterpret_cast<T *> ( bytes ), reinterpret_cast<T *> ( bytes + vertices ),
+                                reinterpret_cast<U *> ( bytes + 2 * vertices ) };
+        }
+
+        soa_fields operator + ( std::size_t idx ) const noexcept
+        { return soa_fields { dst_vertex + idx, reverse_edge_index + idx, r_capacity + idx }; }
+
+        reference operator [] ( std::size_t idx ) const noexcept
+        { return reference { dst_vertex[idx], reverse_edge_index[idx], r_capacity[idx] }; }
+    };
+
+    template <typename T, typename U>
+    struct soa_fields<cached_edge<T, U>>
+    {
+        T * dst_vertex;
+        T * reverse_edge_index;
+        U * r_capacity;
+        U * reverse_r_capacity;
+
+        struct reference
+        {
+            T & dst_vertex;
+            T & reverse_edge_index;
+            U & r_capacity;
+            U & reverse_r_capacity;
+
+            const reference & operator = ( const cached_edge<T, U> & edge ) const noexcept
+            {
+                dst_vertex = edge . dst_vertex;
+                reverse_edge_index = edge . reverse_edge_index;
+                r_capacity = edge . r_capacity;
+                reverse_r_capacity = edge . reverse_r_capacity;
+                return *this;
+            }
+        };
+
+        static std::size_t storage_bytes ( std::size_t arc_cnt ) noexcept
+        {
+            return 2 * soa_array_bytes ( arc_cnt * sizeof ( T ) ) + 2 * soa_array_bytes ( arc_cnt * sizeof ( U ) );
+        }
+
+        static soa_fields in ( void * storage, std::size_t arc_cnt ) noexcept
+        {
+            auto * bytes = static_cast<char *> ( storage );
+            const auto vertices = soa_array_bytes ( arc_cnt * sizeof ( T ) );
+            const auto capacities = soa_array_bytes ( arc_cnt * sizeof ( U ) );
+            return soa_fields { reinterpret_cast<T *> ( bytes ), reinterpret_cast<T *> ( bytes + vertices ),
+                                reinterpret_cast<U *> ( bytes + 2 * vertices ),
+                                reinterpret_cast<U *> ( bytes + 2 * vertices + capacities ) };
+        }
+
+        soa_fields operator + ( std::size_t idx ) const noexcept
+        { return soa_fields { dst_vertex + idx, reverse_edge_index + idx, r_capacity + idx, reverse_r_capacity + idx }; }
+
+        reference operator [] ( std::size_t idx ) const noexcept
+        { return reference { dst_vertex[idx], reverse_edge_index[idx], r_capacity[idx], reverse_r_capacity[idx] }; }
+    };
+
+
+    template <typename edge>
+    class soa_csr
+    {
+        soa_fields<edge> _fields { };
+        std::size_t _size { 0 };
+    public:
+        class iterator
+        {
+            soa_fields<edge> _fields;
+            std::size_t _idx;
+        public:
+            iterator ( soa_fields<edge> fields, std::size_t idx ) noexcept : _fields ( fields ), _idx ( idx )
+            { }
+
+            typename soa_fields<edge>::reference operator * ( ) const noexcept
+            { return _fields[_idx]; }
+
+            iterator & operator ++ ( ) noexcept
+            {
+                ++_idx;
+                return *this;
+            }
+
+            bool operator != ( const iterator & other ) const noexcept
+            { return _idx != other . _idx; }
+        };
+
+        soa_csr ( ) = default;
+
+        soa_csr ( soa_fields<edge> fields, std::size_t size ) noexcept : _fields ( fields ), _size ( size )
+        { }
+
+        iterator begin ( ) const noexcept
+        { return iterator ( _fields, 0 ); }
+
+        iterator end ( ) const noexcept
+        { return iterator ( _fields, _size ); }
+
+        std::size_t size ( ) const noexcept
+        { return _size; }
+
+        typename soa_fields<edge>::reference operator [] ( std::size_t idx ) const noexcept
+        { return _fields[idx]; }
+
+        //the member arrays of the arcs, for kernels which scan a member over all arcs
+        const soa_fields<edge> & fields ( ) const noexcept
+        { return _fields; }
+    };
+
+
+    template <typename edge>
+    class soa_csr<soa_csr<edge>>
+    {
+        std::shared_ptr<std::size_t[]> _offsets { nullptr };
+        std::shared_ptr<void> _storage { nullptr };
+        soa_fields<edge> _fields { };
+        std::size_t _vertex_cnt { 0 };
+    public:
+        using edge_type = edge;
+        static constexpr uint32_t arc_layout = 1;
+
+        soa_csr ( ) = default;
+
+        //offsets hold vertex_cnt + 1 entries, arcs are left uninitialized so that they can be filled in parallel
+        soa_csr ( std::shared_ptr<std::size_t[]> offsets, std::size_t vertex_cnt ) :
+                _offsets ( std::move ( offsets ) ),
+                _vertex_cnt ( vertex_cnt )
+        {
+            const auto bytes = storage_bytes ( _offsets[vertex_cnt] );
+            _storage = std::shared_ptr<void> ( std::aligned_alloc ( soa_alignment, bytes > 0 ? bytes : soa_alignment ), std::free );
+            if ( !_storage )
+                throw std::bad_alloc ();
+            _fields = soa_fields<edge>::in ( _storage . get (), _offsets[vertex_cnt] );
+        }
+
+        //uses existing arrays, storage holds storage_bytes ( arc_count ) bytes aligned to soa_alignment
+        soa_csr ( std::shared_ptr<std::size_t[]> offsets, std::shared_ptr<void> storage, std::size_t vertex_cnt ) noexcept :
+                _offsets ( std::move ( offsets ) ),
+                _storage ( std::move ( storage ) ),
+                _fields ( soa_fields<edge>::in ( _storage . get (), _offsets[vertex_cnt] ) ),
+                _vertex_cnt ( vertex_cnt )
+        { }
+
+        soa_csr ( soa_csr && other ) noexcept = default;
+
+        soa_csr & operator = ( soa_csr && other ) noexcept = default;
+
+        soa_csr ( const soa_csr & other ) = delete;
+
+        soa_csr & operator = ( const soa_csr & other ) = delete;
+
+        static std::size_t storage_bytes ( std::size_t arc_cnt ) noexcept
+        { return soa_fields<edge>::storage_bytes ( arc_cnt ); }
+
+        std::size_t size ( ) const noexcept
+        { return _vertex_cnt; }
+
+        std::size_t arc_count ( ) const noexcept
+        { return _offsets[_vertex_cnt]; }
+
+        std::size_t offset ( std::size_t vertex ) const noexcept
+        { return _offsets[vertex]; }
+
+        const std::size_t * offsets ( ) const noexcept
+        { return _offsets . get (); }
+
+        //networks with the same topology can share the offsets
+        std::shared_ptr<std::size_t[]> shared_offsets ( ) const noexcept
+        { return _offsets; }
+
+        void * storage ( ) const noexcept
+        { return _storage . get (); }
+
+        typename soa_fields<edge>::reference arc ( std::size_t idx ) const noexcept
+        { return _fields[idx]; }
+
+        soa_csr<edge> operator [] ( std::size_t vertex ) const noexcept
+        { return soa_csr<edge> ( _fields + _offsets[vertex], _offsets[vertex + 1] - _offsets[vertex] ); }
+    };
+}
+
+#endif //MAXFLOW_SOA_CSR_H
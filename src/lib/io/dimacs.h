@@ -0,0 +1,221 @@
+/*
+ * Reader for max flow problems in the DIMACS format: comment lines "c ...", the problem line "p max n m", the
+ * terminal lines "n id s" / "n id t" and the arc lines "a u v capacity", with vertices numbered from 1. The part of the
+ * file after the problem line is split into chunks on line boundaries, the arc lines of every chunk are counted and
+ * then parsed in parallel straight into the arrays of a COO matrix.
+ */
+
+#ifndef MAXFLOW_DIMACS_H
+#define MAXFLOW_DIMACS_H
+
+#include <cstring>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <stdexcept>
+#include <algorithm>
+#include <omp.h>
+#include "../algorithms/parallel/prefix_sum.h"
+
+namespace dimacs
+{
+    constexpr std::size_t no_vertex = std::numeric_limits<std::size_t>::max ();
+
+    struct problem
+    {
+        std::size_t vertex_cnt;
+        std::size_t arc_cnt;
+        const char * body;      // first line after the problem line
+        const char * end;
+    };
+
+    template <typename T>
+    struct arc_list
+    {
+        std::unique_ptr<T[]> tails;
+        std::unique_ptr<T[]> heads;
+        std::unique_ptr<uint64_t[]> capacities;
+        std::size_t size { 0 };
+        std::size_t source { no_vertex };
+        std::size_t sink { no_vertex };
+        uint64_t max_capacity { 0 };
+    };
+
+    //calls fn ( begin, end ) for every line in [begin, end), without the line break
+    template <typename line_fn>
+    inline void for_each_line ( const char * begin, const char * end, line_fn fn )
+    {
+        while ( begin < end )
+        {
+            auto * line_break = static_cast<const char *> ( std::memchr ( begin, '\n', end - begin ) );
+            auto * line_end = line_break ? line_break : end;
+            fn ( begin, line_end );
+            begin = line_end + 1;
+        }
+    }
+
+    inline void skip_blanks ( const char * & pos, const char * end ) noexcept
+    {
+        while ( pos < end && ( *pos == ' ' || *pos == '\t' || *pos == '\r' ) )
+            ++pos;
+    }
+
+    inline bool parse_number ( const char * & pos, const char * end, uint64_t & value ) noexcept
+    {
+        skip_blanks ( pos, end );
+        if ( pos == end || *pos < '0' || *pos > '9' )
+            return false;
+        value = 0;
+        for ( ; pos < end && *pos >= '0' && *pos <= '9'; ++pos )
+        {
+            uint64_t digit = *pos - '0';
+            if ( value > ( std::numeric_limits<uint64_t>::max () - digit ) / 10 )
+                return false;
+            value = value * 10 + digit;
+        }
+        return true;
+    }
+
+    inline bool at_line_end ( const char * pos, const char * end ) noexcept
+    {
+        skip_blanks ( pos, end );
+        return pos == end;
+    }
+
+    [[noreturn]] inline void malformed ( const char * begin, const char * end )
+    {
+        throw std::invalid_argument ( "malformed DIMACS line: " + std::string ( begin, end ) );
+    }
+
+    //finds and parses the problem line, which must precede all terminal and arc lines
+    inline problem read_problem ( const char * data, std::size_t size )
+    {
+        const char * pos = data, * end = data + size;
+        while ( pos < end )
+        {
+            auto * line_break = static_cast<const char *> ( std::memchr ( pos, '\n', end - pos ) );
+            auto * line_end = line_break ? line_break : end;
+            const char * cur = pos;
+            skip_blanks ( cur, line_end );
+            if ( cur != line_end && *cur != 'c' )
+            {
+                uint64_t n, m;
+                if ( line_end - cur < 5 || std::strncmp ( cur, "p max", 5 ) != 0 )
+                    malformed ( pos, line_end );
+                cur += 5;
+                if ( !parse_number ( cur, line_end, n ) || !parse_number ( cur, line_end, m ) || !at_line_end ( cur, line_end ) || n < 2 )
+                    malformed ( pos, line_end );
+                return problem { n, m, std::min ( line_end + 1, end ), end };
+            }
+            pos = line_end + 1;
+        }
+        throw std::invalid_argument ( "DIMACS file has no problem line" );
+    }
+
+    //vertices are renumbered from 0, the source and sink are no_vertex if the file does not declare them
+    template <typename T>
+    arc_list<T> read_arcs ( const problem & prob, std::size_t thread_count )
+    {
+        const std::size_t body_size = prob . end - prob . body;
+        const std::size_t chunk_cnt = std::max<std::size_t> ( 1, std::min ( thread_count * 8, body_size >> 20 ) );
+        const int threads = static_cast<int> ( thread_count );
+
+        auto bounds = std::make_unique<const char *[]> ( chunk_cnt + 1 );
+        bounds[0] = prob . body;
+        bounds[chunk_cnt] = prob . end;
+        for ( std::size_t c = 1; c < chunk_cnt; ++c )
+        {
+            const char * raw = prob . body + body_size * c / chunk_cnt - 1;
+            auto * line_break = static_cast<const char *> ( std::memchr ( raw, '\n', prob . end - raw ) );
+            bounds[c] = line_break ? line_break + 1 : prob . end;
+        }
+
+        auto arc_start = std::make_unique<std::size_t[]> ( chunk_cnt + 1 );
+        #pragma omp parallel for schedule(dynamic, 1) num_threads(threads)
+        for ( std::size_t c = 0; c < chunk_cnt; ++c )
+        {
+            std::size_t cnt = 0;
+            for_each_line ( bounds[c], bounds[c + 1], [&] ( const char * begin, const char * end )
+            {
+                skip_blanks ( begin, end );
+                cnt += begin != end && *begin == 'a';
+            } );
+            arc_start[c] = cnt;
+        }
+
+        arc_list<T> arcs;
+        arcs . size = prefix_sum::exclusive_scan ( arc_start . get (), chunk_cnt + 1, thread_count );
+        arcs . tails . reset ( new T[arcs . size] );
+        arcs . heads . reset ( new T[arcs . size] );
+        arcs . capacities . reset ( new uint64_t[arcs . size] );
+
+        //per chunk: first malformed line, declared source and sink, largest capacity
+        struct chunk_result
+        {
+            const char * error_begin { nullptr }, * error_end { nullptr };
+            std::size_t source { no_vertex }, sink { no_vertex };
+            uint64_t max_capacity { 0 };
+        };
+        auto results = std::make_unique<chunk_result[]> ( chunk_cnt );
+
+        #pragma omp parallel for schedule(dynamic, 1) num_threads(threads)
+        for ( std::size_t c = 0; c < chunk_cnt; ++c )
+        {
+            auto & result = results[c];
+            auto pos = arc_start[c];
+            for_each_line ( bounds[c], bounds[c + 1], [&] ( const char * begin, const char * end )
+            {
+                const char * cur = begin;
+                skip_blanks ( cur, end );
+                if ( cur == end || *cur == 'c' || result . error_begin )
+                    return;
+                uint64_t u, v, cap;
+                const char kind = *cur++;
+                if ( kind == 'a' && parse_number ( cur, end, u ) && parse_number ( cur, end, v ) && parse_number ( cur, end, cap )
+                     && at_line_end ( cur, end ) && u >= 1 && u <= prob . vertex_cnt && v >= 1 && v <= prob . vertex_cnt )
+                {
+                    arcs . tails[pos] = static_cast<T> ( u - 1 );
+                    arcs . heads[pos] = static_cast<T> ( v - 1 );
+                    arcs . capacities[pos++] = cap;
+                    result . max_capacity = std::max ( result . max_capacity, cap );
+                    return;
+                }
+                if ( kind == 'n' && parse_number ( cur, end, u ) && u >= 1 && u <= prob . vertex_cnt )
+                {
+                    skip_blanks ( cur, end );
+                    if ( cur != end && ( *cur == 's' || *cur == 't' ) && at_line_end ( cur + 1, end ) )
+                    {
+                        auto & terminal = *cur == 's' ? result . source : result . sink;
+                        if ( terminal == no_vertex || terminal == u - 1 )
+                        {
+                            terminal = u - 1;
+                            return;
+                        }
+                    }
+                }
+                result . error_begin = begin;
+                result . error_end = end;
+            } );
+        }
+
+        for ( std::size_t c = 0; c < chunk_cnt; ++c )
+        {
+            const auto & result = results[c];
+            if ( result . error_begin )
+                malformed ( result . error_begin, result . error_end );
+            if ( result . source != no_vertex && arcs . source != no_vertex && result . source != arcs . source )
+                throw std::invalid_argument ( "DIMACS file declares more than one source" );
+            if ( result . sink != no_vertex && arcs . sink != no_vertex && result . sink != arcs . sink )
+                throw std::invalid_argument ( "DIMACS file declares more than one sink" );
+            if ( result . source != no_vertex )
+                arcs . source = result . source;
+            if ( result . sink != no_vertex )
+                arcs . sink = result . sink;
+            arcs . max_capacity = std::max ( arcs . max_capacity, result . max_capacity );
+        }
+        return arcs;
+    }
+}
+
+#endif //MAXFLOW_DIMACS_H
@@ -0,0 +1,71 @@
+/*
+ * Memory mapping of a whole file. The pages are loaded lazily by the kernel, so a file can be parsed in parallel
+ * without first being copied into memory. A copy-on-write mapping can be modified, the changes stay private to the
+ * process and never reach the file.
+ */
+
+#ifndef MAXFLOW_MAPPED_FILE_H
+#define MAXFLOW_MAPPED_FILE_H
+
+#include <string>
+#include <ios>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace io
+{
+    class mapped_file
+    {
+        void * _data { nullptr };
+        std::size_t _size { 0 };
+    public:
+        explicit mapped_file ( const std::string & path, bool copy_on_write = false )
+        {
+            int fd = ::open ( path . c_str (), O_RDONLY );
+            if ( fd < 0 )
+                throw std::ios_base::failure ( "cannot open " + path );
+
+            struct stat st { };
+            if ( ::fstat ( fd, &st ) != 0 )
+            {
+                ::close ( fd );
+                throw std::ios_base::failure ( "cannot stat " + path );
+            }
+
+            _size = st . st_size;
+            if ( _size > 0 )
+            {
+                const int protection = copy_on_write ? PROT_READ | PROT_WRITE : PROT_READ;
+                _data = ::mmap ( nullptr, _size, protection, MAP_PRIVATE, fd, 0 );
+                if ( _data == MAP_FAILED )
+                {
+                    ::close ( fd );
+                    throw std::ios_base::failure ( "cannot map " + path );
+                }
+                ::madvise ( _data, _size, MADV_WILLNEED );
+            }
+            ::close ( fd );
+        }
+
+        ~mapped_file ( )
+        {
+            if ( _size > 0 )
+                ::munmap ( _data, _size );
+        }
+
+        mapped_file ( const mapped_file & other ) = delete;
+
+        mapped_file & operator = ( const mapped_file & other ) = delete;
+
+        //writable only for copy-on-write mappings
+        char * data ( ) const noexcept
+        { return static_cast<char *> ( _data ); }
+
+        std::size_t size ( ) const noexcept
+        { return _size; }
+    };
+}
+
+#endif //MAXFLOW_MAPPED_FILE_H
@@ -0,0 +1,179 @@
+/*
+ * Binary snapshot of a built residual network. The layout is a fixed header followed by the offsets array and the
+ * arc storage exactly as they are held in memory, each section aligned to 64 bytes, so that a snapshot can be mapped
+ * and solved on without any parsing. Arcs keep their reverse indices and, for cached edges, reverse_r_capacity.
+ * Snapshots are only readable by builds with the same arc layout and on machines with the same byte order.
+ */
+
+#ifndef MAXFLOW_SNAPSHOT_H
+#define MAXFLOW_SNAPSHOT_H
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
+#include "../common_types.h"
+#include "mapped_file.h"
+
+namespace snapshot
+{
+    constexpr char magic[8] = { 'M', 'A', 'X', 'F', 'L', 'O', 'W', 'G' };
+    constexpr uint32_t version = 1;
+    constexpr uint32_t byte_order_mark = 0x01020304;
+    constexpr std::size_t alignment = 64;
+
+    static_assert ( sizeof ( std::size_t ) == sizeof ( uint64_t ), "offsets are stored as 64 bit integers" );
+
+    struct header
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t byte_order;
+        uint32_t vertex_bytes;
+        uint32_t capacity_bytes;
+        uint32_t edge_kind;         // 1: basic_edge, 2: cached_edge
+        uint32_t edge_bytes;
+        uint32_t arc_layout;        // 0: data_structures::csr, 1: data_structures::soa_csr
+        uint32_t reserved;
+        uint64_t vertex_cnt;
+        uint64_t arc_cnt;
+        uint64_t offsets_pos;
+        uint64_t arcs_pos;
+        uint64_t size;
+    };
+
+    template <typename edge>
+    struct edge_traits;
+
+    template <typename T, typename U>
+    struct edge_traits<basic_edge<T, U>>
+    {
+        using vertex_type = T;
+        using capacity_type = U;
+        static constexpr uint32_t kind = 1;
+    };
+
+    template <typename T, typename U>
+    struct edge_traits<cached_edge<T, U>>
+    {
+        using vertex_type = T;
+        using capacity_type = U;
+        static constexpr uint32_t kind = 2;
+    };
+
+    inline uint64_t align ( uint64_t pos ) noexcept
+    {
+        return ( pos + alignment - 1 ) / alignment * alignment;
+    }
+
+    template <typename network>
+    header make_header ( const network & graph ) noexcept
+    {
+        using edge = typename network::edge_type;
+        using traits = edge_traits<edge>;
+
+        header head { };
+        std::memcpy ( head . magic, magic, sizeof ( magic ) );
+        head . version = version;
+        head . byte_order = byte_order_mark;
+        head . vertex_bytes = sizeof ( typename traits::vertex_type );
+        head . capacity_bytes = sizeof ( typename traits::capacity_type );
+        head . edge_kind = traits::kind;
+        head . edge_bytes = sizeof ( edge );
+        head . arc_layout = network::arc_layout;
+        head . vertex_cnt = graph . size ();
+        head . arc_cnt = graph . arc_count ();
+        head . offsets_pos = align ( sizeof ( header ) );
+        head . arcs_pos = align ( head . offsets_pos + ( head . vertex_cnt + 1 ) * sizeof ( uint64_t ) );
+        head . size = head . arcs_pos + network::storage_bytes ( head . arc_cnt );
+        return head;
+    }
+
+    //out must hold make_header ( graph ) . size bytes
+    template <typename network>
+    void write ( const network & graph, char * out ) noexcept
+    {
+        const auto head = make_header ( graph );
+        std::memset ( out, 0, head . arcs_pos );
+        std::memcpy ( out, &head, sizeof ( header ) );
+        std::memcpy ( out + head . offsets_pos, graph . offsets (), ( head . vertex_cnt + 1 ) * sizeof ( uint64_t ) );
+        std::memcpy ( out + head . arcs_pos, graph . storage (), head . size - head . arcs_pos );
+    }
+
+    template <typename network>
+    void save ( const network & graph, const std::string & path )
+    {
+        const auto head = make_header ( graph );
+        const char padding[alignment] { };
+        std::ofstream file ( path, std::ios::binary | std::ios::trunc );
+        if ( !file )
+            throw std::ios_base::failure ( "cannot open " + path );
+
+        file . write ( reinterpret_cast<const char *> ( &head ), sizeof ( header ) );
+        file . write ( padding, head . offsets_pos - sizeof ( header ) );
+        file . write ( reinterpret_cast<const char *> ( graph . offsets () ), ( head . vertex_cnt + 1 ) * sizeof ( uint64_t ) );
+        file . write ( padding, head . arcs_pos - head . offsets_pos - ( head . vertex_cnt + 1 ) * sizeof ( uint64_t ) );
+        file . write ( static_cast<const char *> ( graph . storage () ), head . size - head . arcs_pos );
+        file . close ();
+        if ( !file )
+            throw std::ios_base::failure ( "cannot write " + path );
+    }
+
+    //checks that data holds a complete snapshot of this version and byte order
+    inline header read_header ( const char * data, std::size_t size )
+    {
+        header head;
+        if ( size < sizeof ( header ) )
+            throw std::invalid_argument ( "not a graph snapshot" );
+        std::memcpy ( &head, data, sizeof ( header ) );
+        if ( std::memcmp ( head . magic, magic, sizeof ( magic ) ) != 0 )
+            throw std::invalid_argument ( "not a graph snapshot" );
+        if ( head . version != version )
+            throw std::invalid_argument ( "unsupported graph snapshot version " + std::to_string ( head . version ) );
+        if ( head . byte_order != byte_order_mark )
+            throw std::invalid_argument ( "graph snapshot was written on a machine with a different byte order" );
+        if ( ( head . vertex_bytes != 4 && head . vertex_bytes != 8 ) || ( head . capacity_bytes != 4 && head . capacity_bytes != 8 )
+             || ( head . edge_kind != 1 && head . edge_kind != 2 ) || head . size != size || head . arcs_pos > size
+             || head . offsets_pos + ( head . vertex_cnt + 1 ) * sizeof ( uint64_t ) > head . arcs_pos )
+            throw std::invalid_argument ( "corrupted graph snapshot" );
+        return head;
+    }
+
+    template <typename network>
+    void check_layout ( const header & head, const char * data )
+    {
+        uint64_t arc_cnt;
+        std::memcpy ( &arc_cnt, data + head . offsets_pos + head . vertex_cnt * sizeof ( uint64_t ), sizeof ( uint64_t ) );
+        if ( head . arc_layout != network::arc_layout )
+            throw std::invalid_argument ( "graph snapshot was written with a different arc layout" );
+        if ( sizeof ( typename network::edge_type ) != head . edge_bytes || arc_cnt != head . arc_cnt
+             || head . arcs_pos + network::storage_bytes ( arc_cnt ) != head . size )
+            throw std::invalid_argument ( "corrupted graph snapshot" );
+    }
+
+    //the network refers to the mapping, which is kept alive as long as the network
+    template <typename network>
+    std::shared_ptr<network> map ( std::shared_ptr<io::mapped_file> file, const header & head )
+    {
+        check_layout<network> ( head, file -> data () );
+        std::shared_ptr<std::size_t[]> offsets ( file, reinterpret_cast<std::size_t *> ( file -> data () + head . offsets_pos ) );
+        std::shared_ptr<void> storage ( file, file -> data () + head . arcs_pos );
+        return std::make_shared<network> ( std::move ( offsets ), std::move ( storage ), head . vertex_cnt );
+    }
+
+    template <typename network>
+    std::shared_ptr<network> copy ( const char * data, const header & head )
+    {
+        check_layout<network> ( head, data );
+        std::unique_ptr<std::size_t[]> offsets ( new std::size_t[head . vertex_cnt + 1] );
+        std::memcpy ( offsets . get (), data + head . offsets_pos, ( head . vertex_cnt + 1 ) * sizeof ( uint64_t ) );
+        auto graph = std::make_shared<network> ( std::move ( offsets ), head . vertex_cnt );
+        std::memcpy ( graph -> storage (), data + head . arcs_pos, head . size - head . arcs_pos );
+        return graph;
+    }
+}
+
+#endif //MAXFLOW_SNAPSHOT_H
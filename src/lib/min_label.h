@@ -0,0 +1,151 @@
+/*
+ * The minimum label over the heads of the residual arcs of a vertex, the scan calculate_new_label does on every
+ * relabel. Networks with arcs stored as a structure of arrays and 32 bit vertices use a vectorized kernel: the residual
+ * capacities give the mask, and the labels are gathered from the vertex records, 8 arcs at a time with AVX-512 and 4 at
+ * a time with AVX2, whichever simd::supported allows. Other networks use the scalar loop.
+ */
+
+#ifndef MAXFLOW_MIN_LABEL_H
+#define MAXFLOW_MIN_LABEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <type_traits>
+#include "simd.h"
+
+namespace min_label
+{
+    //labels points to the label of the first vertex record, the records being stride bytes apart
+    template <typename U>
+    uint32_t scalar ( const uint32_t * heads, const U * r_capacities, std::size_t size, const char * labels,
+                      std::size_t stride, uint32_t init ) noexcept
+    {
+        for ( std::size_t i = 0; i < size; ++i )
+        {
+            if ( r_capacities[i] == 0 )
+                continue;
+            uint32_t label;
+            std::memcpy ( &label, labels + heads[i] * stride, sizeof ( label ) );
+            init = std::min ( init, label );
+        }
+        return init;
+    }
+
+#ifdef MAXFLOW_SIMD_KERNELS
+    template <typename U>
+    __attribute__ (( target ( "avx512f" ) ))
+    uint32_t avx512 ( const uint32_t * heads, const U * r_capacities, std::size_t size, const char * labels,
+                      std::size_t stride, uint32_t init ) noexcept
+    {
+        const __m512i step = _mm512_set1_epi64 ( static_cast<long long> ( stride ) );
+        __m256i result = _mm256_set1_epi32 ( static_cast<int> ( init ) );
+        for ( std::size_t i = 0; i < size; i += 8 )
+        {
+            const __mmask8 lanes = size - i >= 8 ? 0xFF : static_cast<__mmask8> ( ( 1u << ( size - i ) ) - 1 );
+            __mmask8 residual;
+            if constexpr ( sizeof ( U ) == 4 )
+            {
+                const __m512i capacities = _mm512_maskz_loadu_epi32 ( lanes, r_capacities + i );
+                residual = static_cast<__mmask8> ( _mm512_test_epi32_mask ( capacities, capacities ) );
+            }
+            else
+            {
+                const __m512i capacities = _mm512_maskz_loadu_epi64 ( lanes, r_capacities + i );
+                residual = _mm512_test_epi64_mask ( capacities, capacities );
+            }
+            if ( residual == 0 )
+                continue;
+            const __m256i vertices = _mm512_castsi512_si256 ( _mm512_maskz_loadu_epi32 ( residual, heads + i ) );
+            const __m512i offsets = _mm512_mul_epu32 ( _mm512_cvtepu32_epi64 ( vertices ), step );
+            const __m256i gathered = _mm512_mask_i64gather_epi32 ( result, residual, offsets, labels, 1 );
+            result = _mm256_min_epu32 ( result, gathered );
+        }
+        __m128i half = _mm_min_epu32 ( _mm256_castsi256_si128 ( result ), _mm256_extracti128_si256 ( result, 1 ) );
+        half = _mm_min_epu32 ( half, _mm_shuffle_epi32 ( half, 0x4E ) );
+        half = _mm_min_epu32 ( half, _mm_shuffle_epi32 ( half, 0xB1 ) );
+        return static_cast<uint32_t> ( _mm_cvtsi128_si32 ( half ) );
+    }
+
+    template <typename U>
+    __attribute__ (( target ( "avx2" ) ))
+    uint32_t avx2 ( const uint32_t * heads, const U * r_capacities, std::size_t size, const char * labels,
+                    std::size_t stride, uint32_t init ) noexcept
+    {
+        const __m256i step = _mm256_set1_epi64x ( static_cast<long long> ( stride ) );
+        __m128i result = _mm_set1_epi32 ( static_cast<int> ( init ) );
+        std::size_t i = 0;
+        for ( ; i + 4 <= size; i += 4 )
+        {
+            __m128i residual;
+            if constexpr ( sizeof ( U ) == 4 )
+                residual = _mm_cmpeq_epi32 ( _mm_loadu_si128 ( reinterpret_cast<const __m128i *> ( r_capacities + i ) ), _mm_setzero_si128 () );
+            else
+            {
+                const __m256i zero = _mm256_cmpeq_epi64 ( _mm256_loadu_si256 ( reinterpret_cast<const __m256i *> ( r_capacities + i ) ),
+                                                          _mm256_setzero_si256 () );
+                residual = _mm256_castsi256_si128 ( _mm256_permutevar8x32_epi32 ( zero, _mm256_setr_epi32 ( 0, 2, 4, 6, 0, 2, 4, 6 ) ) );
+            }
+            residual = _mm_xor_si128 ( residual, _mm_set1_epi32 ( -1 ) );
+            if ( _mm_testz_si128 ( residual, residual ) )
+                continue;
+            const __m256i offsets = _mm256_mul_epu32 ( _mm256_cvtepu32_epi64 ( _mm_loadu_si128 ( reinterpret_cast<const __m128i *> ( heads + i ) ) ), step );
+            const __m128i gathered = _mm256_mask_i64gather_epi32 ( result, reinterpret_cast<const int *> ( labels ), offsets, residual, 1 );
+            result = _mm_min_epu32 ( result, gathered );
+        }
+        result = _mm_min_epu32 ( result, _mm_shuffle_epi32 ( result, 0x4E ) );
+        result = _mm_min_epu32 ( result, _mm_shuffle_epi32 ( result, 0xB1 ) );
+        return scalar ( heads + i, r_capacities + i, size - i, labels, stride, static_cast<uint32_t> ( _mm_cvtsi128_si32 ( result ) ) );
+    }
+#endif
+
+    template <typename U>
+    using kernel = uint32_t ( * ) ( const uint32_t *, const U *, std::size_t, const char *, std::size_t, uint32_t ) noexcept;
+
+    template <typename U>
+    kernel<U> select ( ) noexcept
+    {
+#ifdef MAXFLOW_SIMD_KERNELS
+        if ( simd::supported == simd::level::avx512 )
+            return avx512<U>;
+        if ( simd::supported == simd::level::avx2 )
+            return avx2<U>;
+#endif
+        return scalar<U>;
+    }
+
+    template <typename U>
+    inline const kernel<U> dispatch = select<U> ();
+
+    template <typename arcs_type, typename = void>
+    struct split_arcs : std::false_type { };
+
+    template <typename arcs_type>
+    struct split_arcs<arcs_type, std::void_t<decltype ( std::declval<const arcs_type &> () . fields () )>> : std::true_type { };
+
+    //the smallest label ( records[edge . dst_vertex] ) over the arcs with r_capacity > 0, or init if there are none
+    template <typename arcs_type, typename record, typename T>
+    inline T over_residual_arcs ( const arcs_type & arcs, const record * records, T record::* label, T init ) noexcept
+    {
+        if constexpr ( split_arcs<arcs_type>::value && std::is_same_v<T, uint32_t> )
+        {
+            const auto fields = arcs . fields ();
+            return dispatch<std::remove_pointer_t<decltype ( fields . r_capacity )>> (
+                    fields . dst_vertex, fields . r_capacity, arcs . size (),
+                    reinterpret_cast<const char *> ( &( records ->* label ) ), sizeof ( record ), init );
+        }
+        else
+        {
+            for ( auto && edge : arcs )
+            {
+                if ( edge . r_capacity == 0 )
+                    continue;
+                init = std::min ( init, records[edge . dst_vertex] .* label );
+            }
+            return init;
+        }
+    }
+}
+
+#endif //MAXFLOW_MIN_LABEL_H
@@ -0,0 +1,101 @@
+/*
+ * Bit masks of the non-zero entries of two arrays, 64 entries at a time: bit k is set if a[k] or b[k] is non-zero. The
+ * dense loader uses them to find the arc pairs of a row of a tile, a being the row of the matrix and b the row of the
+ * transposed tile. The vectorized kernels OR the two arrays and compare with zero, 16 or 8 entries at a time with
+ * AVX-512 and 8 or 4 with AVX2, whichever simd::supported allows.
+ */
+
+#ifndef MAXFLOW_NONZERO_MASK_H
+#define MAXFLOW_NONZERO_MASK_H
+
+#include <cstddef>
+#include <cstdint>
+#include "simd.h"
+
+namespace nonzero_mask
+{
+    constexpr std::size_t width = 64;
+
+    //size <= width entries
+    template <typename U>
+    uint64_t scalar ( const U * a, const U * b, std::size_t size ) noexcept
+    {
+        uint64_t mask = 0;
+        for ( std::size_t k = 0; k < size; ++k )
+            mask |= static_cast<uint64_t> ( ( a[k] | b[k] ) != 0 ) << k;
+        return mask;
+    }
+
+#ifdef MAXFLOW_SIMD_KERNELS
+    template <typename U>
+    __attribute__ (( target ( "avx512f" ) ))
+    uint64_t avx512 ( const U * a, const U * b ) noexcept
+    {
+        constexpr std::size_t lanes = 64 / sizeof ( U );
+        uint64_t mask = 0;
+        for ( std::size_t k = 0; k < width; k += lanes )
+        {
+            const __m512i entries = _mm512_or_si512 ( _mm512_loadu_si512 ( a + k ), _mm512_loadu_si512 ( b + k ) );
+            if constexpr ( sizeof ( U ) == 4 )
+                mask |= static_cast<uint64_t> ( _mm512_test_epi32_mask ( entries, entries ) ) << k;
+            else
+                mask |= static_cast<uint64_t> ( _mm512_test_epi64_mask ( entries, entries ) ) << k;
+        }
+        return mask;
+    }
+
+    template <typename U>
+    __attribute__ (( target ( "avx2" ) ))
+    uint64_t avx2 ( const U * a, const U * b ) noexcept
+    {
+        constexpr std::size_t lanes = 32 / sizeof ( U );
+        constexpr uint64_t all = ( uint64_t ( 1 ) << lanes ) - 1;
+        uint64_t mask = 0;
+        for ( std::size_t k = 0; k < width; k += lanes )
+        {
+            const __m256i entries = _mm256_or_si256 ( _mm256_loadu_si256 ( reinterpret_cast<const __m256i *> ( a + k ) ),
+                                                      _mm256_loadu_si256 ( reinterpret_cast<const __m256i *> ( b + k ) ) );
+            uint64_t zero;
+            if constexpr ( sizeof ( U ) == 4 )
+                zero = static_cast<uint64_t> ( _mm256_movemask_ps ( _mm256_castsi256_ps ( _mm256_cmpeq_epi32 ( entries, _mm256_setzero_si256 () ) ) ) );
+            else
+                zero = static_cast<uint64_t> ( _mm256_movemask_pd ( _mm256_castsi256_pd ( _mm256_cmpeq_epi64 ( entries, _mm256_setzero_si256 () ) ) ) );
+            mask |= ( zero ^ all ) << k;
+        }
+        return mask;
+    }
+#endif
+
+    template <typename U>
+    uint64_t full ( const U * a, const U * b ) noexcept
+    {
+        return scalar ( a, b, width );
+    }
+
+    template <typename U>
+    using kernel = uint64_t ( * ) ( const U *, const U * ) noexcept;
+
+    template <typename U>
+    kernel<U> select ( ) noexcept
+    {
+#ifdef MAXFLOW_SIMD_KERNELS
+        if ( simd::supported == simd::level::avx512 )
+            return avx512<U>;
+        if ( simd::supported == simd::level::avx2 )
+            return avx2<U>;
+#endif
+        return full<U>;
+    }
+
+    template <typename U>
+    inline const kernel<U> dispatch = select<U> ();
+
+    //the mask of a[0, size) and b[0, size), size <= width
+    template <typename U>
+    inline uint64_t of ( const U * a, const U * b, std::size_t size ) noexcept
+    {
+        return size == width ? dispatch<U> ( a, b ) : scalar ( a, b, size );
+    }
+}
+
+#endif //MAXFLOW_NONZERO_MASK_H
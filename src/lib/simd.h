@@ -0,0 +1,41 @@
+/*
+ * The instruction sets the vectorized kernels may use. The kernels are compiled with target attributes, so the rest of
+ * the extension needs no special flags, and the best set the processor supports is chosen once at runtime. The
+ * environment variable MAXFLOW_SIMD=avx2 or MAXFLOW_SIMD=scalar caps the choice. Builds with MAXFLOW_NO_SIMD or for
+ * other architectures than x86-64 only have the scalar loops.
+ */
+
+#ifndef MAXFLOW_SIMD_H
+#define MAXFLOW_SIMD_H
+
+#include <cstdlib>
+#include <cstring>
+
+#if !defined ( MAXFLOW_NO_SIMD ) && defined ( __x86_64__ ) && ( defined ( __GNUC__ ) || defined ( __clang__ ) )
+#define MAXFLOW_SIMD_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace simd
+{
+    enum class level { scalar, avx2, avx512 };
+
+    inline level detect ( ) noexcept
+    {
+#ifdef MAXFLOW_SIMD_KERNELS
+        const char * cap = std::getenv ( "MAXFLOW_SIMD" );
+        if ( cap && std::strcmp ( cap, "scalar" ) == 0 )
+            return level::scalar;
+        __builtin_cpu_init ();
+        if ( !( cap && std::strcmp ( cap, "avx2" ) == 0 ) && __builtin_cpu_supports ( "avx512f" ) )
+            return level::avx512;
+        if ( __builtin_cpu_supports ( "avx2" ) )
+            return level::avx2;
+#endif
+        return level::scalar;
+    }
+
+    inline const level supported = detect ();
+}
+
+#endif //MAXFLOW_SIMD_H
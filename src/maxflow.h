@@ -3,8 +3,14 @@
 #include <fstream>
 #include "lib/common_types.h"
 #include <vector>
+#include <limits>
+#include <string>
+#include <stdexcept>
 #include <unordered_map>
 #include "graph_loader.h"
+#include "lib/io/mapped_file.h"
+#include "lib/io/dimacs.h"
+#include "lib/io/snapshot.h"
 #include "lib/algorithms/parallel/push_relabel_segment.h"
 #include "lib/algorithms/sequential/ahuja_orlin.h"
 #include "lib/algorithms/parallel/parallel_push_relabel.h"
@@ -12,110 +18,598 @@
 #include "lib/algorithms/sequential/push_relabel_fifo.h"
 #include "lib/algorithms/sequential/edmonds_karp.h"
 #include "lib/algorithms/sequential/dinic.h"
+#include "lib/algorithms/sequential/boykov_kolmogorov.h"
+#include "lib/algorithms/sequential/vertex_order.h"
 #include "lib/algorithms/parallel/ahuja_orlin_segment.h"
+#include "lib/algorithms/parallel/async_push_relabel.h"
 #include "chrono"
 
-#define DEFAULT_VECTOR std::vector
-
 size_t g_next_idx = 0;
 std::unordered_map<int, std::shared_ptr<void>> GraphMap; 
 
-template<typename T, typename U, template <typename, typename> typename EDGE>
-auto load_graph_dense(size_t A_ptr, size_t n, int graph_idx, bool& run_maxflow) {
-    // Use graph_idx >= 0 for loading an existing graph and running max_flow
-    // Use graph_idx = -1 for loading and running max_flow
-    // Use graph_idx = -2 for loading and saving the graph
-    // Use graph_idx = -3 for loading, saving the graph, and running max_flow
-
-    run_maxflow = true;
-    if (graph_idx < 0) { 
-        auto graph = _load_graph_dense<T, U, EDGE>((void*) A_ptr, n); // Returns a pointer.
-        if (graph_idx == -2) {
-            run_maxflow = false;
-            GraphMap[g_next_idx] = std::static_pointer_cast<void> (graph);
-            ++g_next_idx;
-        } else if (graph_idx == -3) {
-            GraphMap[g_next_idx] = std::static_pointer_cast<void> (graph);
-            ++g_next_idx;
-        }
-        return graph;
+// Mode 1: <uint32_t, uint32_t>, mode 2: <uint32_t, uint64_t>, mode 3: <uint64_t, uint32_t>, mode 4: <uint64_t, uint64_t>.
+// Calls f ( T {}, U {} ) with the vertex type T and capacity type U of the mode.
+template <typename fn>
+auto _with_types(int mode, fn f) {
+    switch(mode) {
+        case 1: return f(uint32_t {}, uint32_t {});
+        case 2: return f(uint32_t {}, uint64_t {});
+        case 3: return f(uint64_t {}, uint32_t {});
+        default: return f(uint64_t {}, uint64_t {});
+    }
+}
+
+
+// Graphs are saved with cached edges whatever algorithm they are loaded for, every run solves on a network with the
+// edge type of the algorithm which is reset to the saved capacities. A saved graph can therefore be solved any number
+// of times, by all the algorithms.
+// Use graph_idx >= 0 for loading an existing graph and running max_flow
+// Use graph_idx = -1 for loading and running max_flow
+// Use graph_idx = -2 for loading and saving the graph
+// Use graph_idx = -3 for loading, saving the graph, and running max_flow
+// build ( edge_type<E> {} ) returns a pointer to the loaded graph with edge type E.
+template<typename T, typename U, template <typename, typename> typename EDGE, typename builder>
+std::shared_ptr<residual_network<T, U, EDGE>> load_graph(int graph_idx, bool& run_maxflow, size_t nthreads, builder build) {
+    run_maxflow = graph_idx != -2;
+    if (graph_idx == -1)
+        return build(edge_type<EDGE> {});
+
+    std::shared_ptr<stored_graph<T, U>> graph;
+    if (graph_idx >= 0) {
+        graph = std::static_pointer_cast<stored_graph<T, U>> (GraphMap[graph_idx]);
     } else {
-        return std::static_pointer_cast<std::vector<std::vector<EDGE<T, U>>>> (GraphMap[graph_idx]);
+        graph = std::make_shared<stored_graph<T, U>> ();
+        graph->network = build(edge_type<cached_edge> {});
+        GraphMap[g_next_idx] = std::static_pointer_cast<void> (graph);
+        ++g_next_idx;
     }
+    if (!run_maxflow)
+        return nullptr;
+    return graph->template residual<EDGE>(nthreads);
+}
+
+
+template<typename T, typename U, template <typename, typename> typename EDGE>
+auto load_graph_dense(size_t A_ptr, size_t n, int graph_idx, bool& run_maxflow, size_t nthreads) {
+    return load_graph<T, U, EDGE>(graph_idx, run_maxflow, nthreads, [&](auto edge) {
+        return _load_graph_dense<T, U, decltype(edge)::template type>((void*) A_ptr, n, nthreads);
+    });
+}
+
+
+template<typename T, typename U, template <typename, typename> typename EDGE>
+auto load_graph_sparse(size_t A_ptr, size_t row_ptr, size_t col_ptr, size_t n, size_t m, int graph_idx, bool& run_maxflow, size_t nthreads) {
+    return load_graph<T, U, EDGE>(graph_idx, run_maxflow, nthreads, [&](auto edge) {
+        return _load_graph_sparse<T, U, decltype(edge)::template type>((void*) A_ptr, (void*) row_ptr, (void*) col_ptr, n, m, nthreads);
+    });
 }
 
 
+// index64 selects int64 instead of int32 indptr and indices arrays, transposed is set for CSC matrices.
 template<typename T, typename U, template <typename, typename> typename EDGE>
-auto load_graph_sparse(size_t A_ptr, size_t row_ptr, size_t col_ptr, size_t n, size_t m, int graph_idx, bool& run_maxflow) {
-    // Use graph_idx >= 0 for loading an existing graph and running max_flow
-    // Use graph_idx = -1 for loading and running max_flow
-    // Use graph_idx = -2 for loading and saving the graph
-    // Use graph_idx = -3 for loading, saving the graph, and running max_flow
-
-    run_maxflow = true;
-    if (graph_idx < 0) { 
-        auto graph = _load_graph_sparse<T, U, EDGE>((void*) A_ptr, (void*) row_ptr, (void*) col_ptr, n, m);
-        if (graph_idx == -2) {
-            run_maxflow = false;
-            GraphMap[g_next_idx] = std::static_pointer_cast<void> (graph);
-            ++g_next_idx;
-        } else if (graph_idx == -3) {
-            GraphMap[g_next_idx] = std::static_pointer_cast<void> (graph);
-            ++g_next_idx;
+auto load_graph_csr(size_t A_ptr, size_t indptr_ptr, size_t indices_ptr, size_t n, bool index64, bool transposed, int graph_idx, bool& run_maxflow, size_t nthreads) {
+    return load_graph<T, U, EDGE>(graph_idx, run_maxflow, nthreads, [&](auto edge) {
+        if (index64)
+            return _load_graph_csr<T, U, decltype(edge)::template type, int64_t>((void*) A_ptr, (void*) indptr_ptr, (void*) indices_ptr, n, transposed, nthreads);
+        return _load_graph_csr<T, U, decltype(edge)::template type, int32_t>((void*) A_ptr, (void*) indptr_ptr, (void*) indices_ptr, n, transposed, nthreads);
+    });
+}
+
+
+// Load and save the graph as with graph_idx = -2, without choosing an algorithm.
+void store_graph_dense(int mode, size_t A_ptr, size_t n, size_t nthreads) {
+    _with_types(mode, [&](auto t, auto u) {
+        bool run_maxflow;
+        load_graph_dense<decltype(t), decltype(u), cached_edge>(A_ptr, n, -2, run_maxflow, nthreads);
+    });
+}
+
+void store_graph_sparse(int mode, size_t A_ptr, size_t row_ptr, size_t col_ptr, size_t n, size_t m, size_t nthreads) {
+    _with_types(mode, [&](auto t, auto u) {
+        bool run_maxflow;
+        load_graph_sparse<decltype(t), decltype(u), cached_edge>(A_ptr, row_ptr, col_ptr, n, m, -2, run_maxflow, nthreads);
+    });
+}
+
+// index_entries keeps the arc of every stored entry with the graph, for exporting the flows of the entries.
+void store_graph_csr(int mode, size_t A_ptr, size_t indptr_ptr, size_t indices_ptr, size_t n, bool index64, bool transposed, size_t nthreads, bool index_entries) {
+    _with_types(mode, [&](auto t, auto u) {
+        using T = decltype(t);
+        using U = decltype(u);
+        bool run_maxflow;
+        if (!index_entries) {
+            load_graph_csr<T, U, cached_edge>(A_ptr, indptr_ptr, indices_ptr, n, index64, transposed, -2, run_maxflow, nthreads);
+            return;
         }
-        return graph;
+
+        auto graph = std::make_shared<stored_graph<T, U>> ();
+        graph->entry_cnt = index64 ? ((const int64_t*) indptr_ptr)[n] : ((const int32_t*) indptr_ptr)[n];
+        graph->entry_arcs.reset(new std::size_t[graph->entry_cnt]);
+        if (index64)
+            graph->network = _load_graph_csr<T, U, cached_edge, int64_t>((void*) A_ptr, (void*) indptr_ptr, (void*) indices_ptr, n, transposed, nthreads, graph->entry_arcs.get());
+        else
+            graph->network = _load_graph_csr<T, U, cached_edge, int32_t>((void*) A_ptr, (void*) indptr_ptr, (void*) indices_ptr, n, transposed, nthreads, graph->entry_arcs.get());
+        GraphMap[g_next_idx] = std::static_pointer_cast<void> (graph);
+        ++g_next_idx;
+    });
+}
+
+// Renumbers the vertices of a saved graph for locality, kind 1: breadth first from root, 2: reverse Cuthill-McKee from
+// root, 3: by decreasing degree. order_ptr receives the n uint64 entries of the order, order[i] being the original
+// number of the vertex numbered i. The entry index of the graph, if any, is kept.
+void reorder_graph(int graph_idx, int mode, int kind, size_t root, size_t order_ptr, size_t nthreads) {
+    _with_types(mode, [&](auto t, auto u) {
+        using T = decltype(t);
+        using U = decltype(u);
+        auto &graph = *std::static_pointer_cast<stored_graph<T, U>> (GraphMap.at(graph_idx));
+        const auto &network = *graph.network;
+        const std::size_t n = network.size();
+        if (root >= n)
+            throw std::invalid_argument("root must be a vertex of the graph");
+
+        auto order = kind == 1 ? vertex_order::bfs(network, static_cast<T> (root))
+                   : kind == 2 ? vertex_order::rcm(network, static_cast<T> (root))
+                   : vertex_order::degree<T>(network);
+        std::vector<T> rank(n);
+        for (std::size_t i = 0; i < n; ++i)
+            rank[order[i]] = static_cast<T> (i);
+
+        graph.network = _permute_graph<T, U, cached_edge>(network, order.data(), rank.data(), nthreads, graph.entry_arcs.get(), graph.entry_cnt);
+        graph.cached_residual.reset();
+        graph.basic_residual.reset();
+        graph.instance.reset();
+        std::copy(order.begin(), order.end(), (uint64_t*) order_ptr);
+    });
+}
+
+struct dimacs_info {
+    int mode;
+    size_t n;
+    size_t m;
+    size_t source;  // dimacs::no_vertex if not declared
+    size_t sink;    // dimacs::no_vertex if not declared
+};
+
+
+// 32 bit capacities are used if the total capacity of all arcs fits, as no excess or flow value can exceed it and
+// neither can the residual capacities of an arc pair, which the loader merges from the arcs in both directions and
+// their duplicates.
+template<typename T>
+dimacs_info _load_dimacs(const dimacs::problem& problem, size_t nthreads) {
+    auto arcs = dimacs::read_arcs<T>(problem, nthreads);
+    const int threads = static_cast<int> (nthreads);
+    dimacs_info info {std::is_same_v<T, uint32_t> ? 1 : 3, problem.vertex_cnt, arcs.size, arcs.source, arcs.sink};
+
+    bool narrow = arcs.max_capacity <= UINT32_MAX;
+    if (narrow) {
+        uint64_t total_capacity = 0;
+        #pragma omp parallel for schedule(static) reduction(+:total_capacity) num_threads(threads)
+        for (size_t i = 0; i < arcs.size; ++i)
+            total_capacity += arcs.capacities[i];
+        narrow = total_capacity <= UINT32_MAX;
+    }
+
+    if (narrow) {
+        std::unique_ptr<uint32_t[]> capacities (new uint32_t[arcs.size]);
+        #pragma omp parallel for schedule(static) num_threads(threads)
+        for (size_t i = 0; i < arcs.size; ++i)
+            capacities[i] = static_cast<uint32_t> (arcs.capacities[i]);
+        arcs.capacities.reset();
+        auto graph = std::make_shared<stored_graph<T, uint32_t>> ();
+        graph->network = _load_graph_sparse<T, uint32_t, cached_edge>(capacities.get(), arcs.tails.get(), arcs.heads.get(), info.n, arcs.size, nthreads);
+        GraphMap[g_next_idx] = std::static_pointer_cast<void> (graph);
     } else {
-        return std::static_pointer_cast<std::vector<std::vector<EDGE<T, U>>>> (GraphMap[graph_idx]);
+        auto graph = std::make_shared<stored_graph<T, uint64_t>> ();
+        graph->network = _load_graph_sparse<T, uint64_t, cached_edge>(arcs.capacities.get(), arcs.tails.get(), arcs.heads.get(), info.n, arcs.size, nthreads);
+        GraphMap[g_next_idx] = std::static_pointer_cast<void> (graph);
+        ++info.mode;
     }
+    ++g_next_idx;
+    return info;
 }
 
+
+// Reads a DIMACS max flow file and saves the graph as with graph_idx = -2.
+dimacs_info load_dimacs(const char* path, size_t nthreads) {
+    io::mapped_file file(path);
+    auto problem = dimacs::read_problem(file.data(), file.size());
+    if (problem.vertex_cnt > UINT32_MAX)
+        return _load_dimacs<uint64_t>(problem, nthreads);
+    return _load_dimacs<uint32_t>(problem, nthreads);
+}
+
+
+struct graph_info {
+    int mode;
+    size_t n;
+    size_t m;
+};
+
+
+// Calls f with a null pointer of the type of the saved graphs.
+template <typename fn>
+auto _with_network(int mode, fn f) {
+    return _with_types(mode, [&](auto t, auto u) {
+        return f(static_cast<stored_graph<decltype(t), decltype(u)>*> (nullptr));
+    });
+}
+
+template <typename fn>
+auto _with_network(int graph_idx, int mode, fn f) {
+    return _with_network(mode, [&](auto tag) {
+        return f(*std::static_pointer_cast<std::remove_pointer_t<decltype(tag)>> (GraphMap.at(graph_idx))->network);
+    });
+}
+
+
+void save_graph(int graph_idx, int mode, const char* path) {
+    _with_network(graph_idx, mode, [&](const auto& network) {
+        snapshot::save(network, path);
+    });
+}
+
+size_t snapshot_size(int graph_idx, int mode) {
+    return _with_network(graph_idx, mode, [&](const auto& network) -> size_t {
+        return snapshot::make_header(network).size;
+    });
+}
+
+void write_snapshot(int graph_idx, int mode, char* buffer) {
+    _with_network(graph_idx, mode, [&](const auto& network) {
+        snapshot::write(network, buffer);
+    });
+}
+
+
+// Saves the network built by make ( tag ) as with graph_idx = -2.
+template <typename fn>
+graph_info _store_snapshot(const snapshot::header& head, fn make) {
+    if (head.edge_kind != 2)
+        throw std::invalid_argument("graph snapshot holds basic edges, save the graph again to solve it");
+    graph_info info {1 + 2 * (head.vertex_bytes == 8) + (head.capacity_bytes == 8), head.vertex_cnt, head.arc_cnt};
+    _with_network(info.mode, [&](auto tag) {
+        auto graph = std::make_shared<std::remove_pointer_t<decltype(tag)>> ();
+        graph->network = make(tag);
+        GraphMap[g_next_idx] = std::static_pointer_cast<void> (graph);
+        ++g_next_idx;
+    });
+    return info;
+}
+
+// The snapshot is mapped copy-on-write, so solving never modifies the file.
+graph_info open_graph(const char* path) {
+    auto file = std::make_shared<io::mapped_file> (path, true);
+    const auto head = snapshot::read_header(file->data(), file->size());
+    return _store_snapshot(head, [&](auto tag) {
+        return snapshot::map<typename std::remove_pointer_t<decltype(tag)>::network_type> (file, head);
+    });
+}
+
+graph_info read_snapshot(const char* data, size_t size) {
+    const auto head = snapshot::read_header(data, size);
+    return _store_snapshot(head, [&](auto tag) {
+        return snapshot::copy<typename std::remove_pointer_t<decltype(tag)>::network_type> (data, head);
+    });
+}
+
+
 size_t destroy_graph(int graph_idx) {
     return GraphMap.erase(graph_idx);
 }
 
 
+template <typename instance, typename = void>
+struct resumable : std::false_type { };
+
+template <typename instance>
+struct resumable<instance, std::void_t<decltype(std::declval<instance&>().resume())>> : std::true_type { };
+
+template <typename instance, typename = void>
+struct has_phase_two : std::false_type { };
+
+template <typename instance>
+struct has_phase_two<instance, std::void_t<decltype(std::declval<instance&>().preflow_to_flow(std::declval<std::size_t (*)(std::size_t)>()))>> : std::true_type { };
+
+
+// Solves a saved graph. An instance that can resume is kept with the graph, so that the next solve with the same
+// algorithm and terminals continues from its preflow after update_capacities instead of starting over. to_flow turns
+// the maximum preflow left by push-relabel algorithms into a flow.
+template <template <typename, typename> typename EDGE, template <template <typename> typename, typename, typename> typename alg, template <class> typename vector, typename T, typename U>
+std::size_t _solve_stored(stored_graph<T, U>& graph, size_t source, size_t sink, size_t nthreads, bool to_flow=false) {
+    using instance = alg<vector, T, U>;
+    auto capacity_of = [network = graph.network](std::size_t arc) -> U {
+        return network->arc(arc).r_capacity;
+    };
+    if constexpr(resumable<instance>::value) {
+        auto &kept = graph.instance;
+        if (kept && kept->alg == typeid(instance) && kept->source == source && kept->sink == sink) {
+            const auto flow = kept->resume();
+            if (to_flow)
+                kept->preflow_to_flow();
+            return flow;
+        }
+
+        auto residual = graph.template residual<EDGE>(nthreads);
+        auto M = std::make_shared<instance>(*residual, source, sink, nthreads);
+        const auto flow = M->find_max_flow();
+        if (to_flow)
+            M->preflow_to_flow(capacity_of);
+        kept.reset(new typename stored_graph<T, U>::resumable_instance {
+            typeid(instance), static_cast<T> (source), static_cast<T> (sink),
+            [M, residual, capacity_of](T vertex, std::size_t idx, U capacity, U new_capacity) {
+                M->update_capacity(vertex, idx, capacity, new_capacity, capacity_of);
+            },
+            [M] { return M->resume(); },
+            [M, capacity_of] { M->preflow_to_flow(capacity_of); }
+        });
+        return flow;
+    } else {
+        auto residual = graph.template residual<EDGE>(nthreads);
+        instance M(*residual, source, sink, nthreads);
+        const auto flow = M.find_max_flow();
+        if constexpr(has_phase_two<instance>::value)
+            if (to_flow)
+                M.preflow_to_flow(capacity_of);
+        return flow;
+    }
+}
+
+
+// Solves a saved graph loaded with an entry index for a flow and writes the flow on the arc of every stored entry to
+// flows, which holds values of the capacity type. An arc u -> v whose reverse arc has capacity as well carries
+// flow only if the flow between u and v leaves u.
 template <template <typename, typename> typename EDGE, template <template <typename> typename, typename, typename> typename alg, template <class> typename vector = std::vector>
-size_t _run_dense(int mode, size_t A_ptr, size_t n, size_t source, size_t sink, int graph_idx, size_t nthreads=1) {
-    bool run_maxflow;
-    size_t flow_value=0;
-    switch(mode) {
-        case 1: 
-            {
-                auto graph = load_graph_dense<uint32_t, uint32_t, EDGE> (A_ptr, n, graph_idx, run_maxflow);
-                if (run_maxflow) {
-                    alg<vector, uint32_t, uint32_t> M(*graph, source, sink, nthreads);                
-                    flow_value = M.find_max_flow();
-                }
-                break;
+std::size_t _solve_flow(int mode, int graph_idx, size_t source, size_t sink, size_t flows_ptr, size_t nthreads) {
+    return _with_types(mode, [&](auto vertex_type, auto capacity_type) -> std::size_t {
+        using T = decltype(vertex_type);
+        using U = decltype(capacity_type);
+        auto &graph = *std::static_pointer_cast<stored_graph<T, U>> (GraphMap.at(graph_idx));
+        if (!graph.entry_arcs)
+            throw std::invalid_argument("the graph was loaded without an entry index");
+
+        const auto flow = _solve_stored<EDGE, alg, vector>(graph, source, sink, nthreads, true);
+        const auto &network = *graph.network;
+        const auto &residual = [&]() -> const auto& {
+            if constexpr(std::is_same_v<EDGE<T,U>, cached_edge<T,U>>)
+                return *graph.cached_residual;
+            else
+                return *graph.basic_residual;
+        }();
+        auto* flows = (U*) flows_ptr;
+        const auto* entry_arcs = graph.entry_arcs.get();
+        const int threads = static_cast<int> (nthreads);
+        #pragma omp parallel for schedule(static) num_threads(threads)
+        for (std::size_t i = 0; i < graph.entry_cnt; ++i) {
+            const auto arc = entry_arcs[i];
+            if (arc == no_arc) {
+                flows[i] = 0;
+                continue;
             }
-        case 2:
-            {
-                auto graph = load_graph_dense<uint32_t, uint64_t, EDGE> (A_ptr, n, graph_idx, run_maxflow);
-                if (run_maxflow) {
-                    alg<vector, uint32_t, uint64_t> M(*graph, source, sink, nthreads);
-                    return M.find_max_flow();
-                }
-                break;
+            const U capacity = network.arc(arc).r_capacity, r_capacity = residual.arc(arc).r_capacity;
+            flows[i] = capacity > r_capacity ? capacity - r_capacity : 0;
+        }
+        return flow;
+    });
+}
+
+
+// Sets the capacity of the arcs src[i] -> dst[i] of a saved graph to capacity[i]. Only arcs between vertices adjacent
+// in the loaded graph, in either direction, exist. Nothing is changed if any of the arcs is invalid.
+void update_capacities(int graph_idx, int mode, size_t src_ptr, size_t dst_ptr, size_t capacity_ptr, size_t k) {
+    const auto* src = (const uint64_t*) src_ptr;
+    const auto* dst = (const uint64_t*) dst_ptr;
+    const auto* capacity = (const uint64_t*) capacity_ptr;
+    _with_types(mode, [&](auto vertex_type, auto capacity_type) {
+        using T = decltype(vertex_type);
+        using U = decltype(capacity_type);
+        auto &graph = *std::static_pointer_cast<stored_graph<T, U>> (GraphMap.at(graph_idx));
+        auto &network = *graph.network;
+
+        std::vector<std::size_t> positions (k);
+        for (std::size_t i = 0; i < k; ++i) {
+            if (src[i] >= network.size() || dst[i] >= network.size())
+                throw std::invalid_argument("vertex out of range");
+            if (capacity[i] > std::numeric_limits<U>::max())
+                throw std::invalid_argument("capacity " + std::to_string(capacity[i]) + " does not fit the capacity type of the graph");
+            auto pos = network.offset(src[i]);
+            while (pos < network.offset(src[i] + 1) && network.arc(pos).dst_vertex != dst[i])
+                ++pos;
+            if (pos == network.offset(src[i] + 1))
+                throw std::invalid_argument("the graph has no arc " + std::to_string(src[i]) + " -> " + std::to_string(dst[i]));
+            positions[i] = pos;
+        }
+
+        for (std::size_t i = 0; i < k; ++i) {
+            auto &&arc = network.arc(positions[i]);
+            const U old_capacity = arc.r_capacity, new_capacity = static_cast<U> (capacity[i]);
+            arc.r_capacity = new_capacity;
+            network.arc(network.offset(arc.dst_vertex) + arc.reverse_edge_index).reverse_r_capacity = new_capacity;
+            if (graph.instance)
+                graph.instance->update_capacity(src[i], positions[i] - network.offset(src[i]), old_capacity, new_capacity);
+        }
+    });
+}
+
+
+// Solves a saved graph for the k pairs sources[i], sinks[i] and writes the flow values to flows. Sequential algorithms
+// solve the pairs concurrently, every thread on its own copy of the arcs which shares the offsets of the saved graph
+// and is reset between pairs. Parallel algorithms solve the pairs one after the other with nthreads threads.
+template <template <typename, typename> typename EDGE, template <template <typename> typename, typename, typename> typename alg, template <class> typename vector = std::vector>
+void _solve_many(int mode, int graph_idx, size_t sources_ptr, size_t sinks_ptr, size_t k, size_t flows_ptr, size_t nthreads, bool threaded=false) {
+    const auto* sources = (const uint64_t*) sources_ptr;
+    const auto* sinks = (const uint64_t*) sinks_ptr;
+    auto* flows = (uint64_t*) flows_ptr;
+    _with_types(mode, [&](auto vertex_type, auto capacity_type) {
+        using T = decltype(vertex_type);
+        using U = decltype(capacity_type);
+        auto &graph = *std::static_pointer_cast<stored_graph<T, U>> (GraphMap.at(graph_idx));
+        if (threaded) {
+            for (size_t i = 0; i < k; ++i)
+                flows[i] = _solve_stored<EDGE, alg, vector>(graph, sources[i], sinks[i], nthreads);
+            return;
+        }
+
+        const int threads = static_cast<int> (std::max<size_t> (1, std::min(nthreads, k)));
+        #pragma omp parallel num_threads(threads)
+        {
+            std::shared_ptr<residual_network<T, U, EDGE>> residual;
+            #pragma omp for schedule(dynamic, 1)
+            for (size_t i = 0; i < k; ++i) {
+                if (residual)
+                    _reset_network<T, U, EDGE>(*residual, *graph.network);
+                else
+                    residual = _solve_network<T, U, EDGE>(*graph.network);
+                alg<vector, T, U> M(*residual, sources[i], sinks[i]);
+                flows[i] = M.find_max_flow();
             }
-        case 3:
-            {
-                auto graph = load_graph_dense<uint64_t, uint32_t, EDGE> (A_ptr, n, graph_idx, run_maxflow);
-                if (run_maxflow) {
-                    alg<vector, uint64_t, uint32_t> M(*graph, source, sink, nthreads);
-                    return M.find_max_flow();
+        }
+    });
+}
+
+
+// Marks the vertices which cannot reach sink in the residual network of a maximum (pre)flow, the source side of a
+// minimum cut.
+template <typename network>
+void _min_cut_side(const network& graph, size_t sink, std::vector<uint8_t>& side) {
+    std::fill(side.begin(), side.end(), 1);
+    std::vector<size_t> queue {sink};
+    side[sink] = 0;
+    for (size_t i = 0; i < queue.size(); ++i) {
+        const auto v = queue[i];
+        for (auto &&arc : graph[v]) {
+            const size_t u = arc.dst_vertex;
+            if (side[u] && graph[u][arc.reverse_edge_index].r_capacity > 0) {
+                side[u] = 0;
+                queue.push_back(u);
+            }
+        }
+    }
+}
+
+
+// Gomory-Hu tree of a saved graph with symmetric capacities by Gusfield's algorithm: every vertex s > 0 in turn is cut
+// from its parent t, the other vertices on its side of the cut which share the parent are moved below s, and if the
+// parent of t is on that side as well, s takes the place of t, which becomes its child. The cuts of the next vertices
+// are computed speculatively, one per thread, and committed in order; a cut depends on nothing but its vertex and the
+// parent of it, so only a cut whose vertex got a new parent meanwhile is computed again. parent[0] is -1.
+template <template <typename, typename> typename EDGE, template <template <typename> typename, typename, typename> typename alg, template <class> typename vector = std::vector>
+void _gomory_hu(int mode, int graph_idx, size_t parent_ptr, size_t weight_ptr, size_t nthreads, bool threaded=false) {
+    auto* parent = (int64_t*) parent_ptr;
+    auto* weight = (uint64_t*) weight_ptr;
+    _with_types(mode, [&](auto vertex_type, auto capacity_type) {
+        using T = decltype(vertex_type);
+        using U = decltype(capacity_type);
+        auto &graph = *std::static_pointer_cast<stored_graph<T, U>> (GraphMap.at(graph_idx));
+        const size_t n = graph.network->size();
+        std::fill_n(parent, n, 0);
+        parent[0] = -1;
+        weight[0] = 0;
+
+        const size_t width = threaded ? 1 : std::max<size_t> (1, std::min(nthreads, n - 1));
+        const size_t solve_threads = threaded ? nthreads : 1;
+        std::vector<std::shared_ptr<residual_network<T, U, EDGE>>> residuals (width);
+        std::vector<std::vector<uint8_t>> sides (width, std::vector<uint8_t> (n));
+        std::vector<int64_t> sinks (width);
+        std::vector<uint64_t> flows (width);
+
+        for (size_t next = 1; next < n; ) {
+            const size_t cnt = std::min(width, n - next);
+            auto cut = [&](size_t w) {
+                auto &residual = residuals[w];
+                if (residual)
+                    _reset_network<T, U, EDGE>(*residual, *graph.network, solve_threads);
+                else
+                    residual = _solve_network<T, U, EDGE>(*graph.network, solve_threads);
+                sinks[w] = parent[next + w];
+                alg<vector, T, U> M(*residual, next + w, sinks[w], solve_threads);
+                flows[w] = M.find_max_flow();
+                _min_cut_side(*residual, sinks[w], sides[w]);
+            };
+            if (cnt == 1) {
+                cut(0);
+            } else {
+                #pragma omp parallel for schedule(dynamic, 1) num_threads(static_cast<int> (cnt))
+                for (size_t w = 0; w < cnt; ++w)
+                    cut(w);
+            }
+
+            for (size_t w = 0; w < cnt && parent[next] == sinks[w]; ++w, ++next) {
+                const int64_t t = sinks[w];
+                weight[next] = flows[w];
+                for (size_t j = 1; j < n; ++j)
+                    if (j != next && parent[j] == t && sides[w][j])
+                        parent[j] = next;
+                if (parent[t] >= 0 && sides[w][parent[t]]) {
+                    parent[next] = parent[t];
+                    parent[t] = next;
+                    std::swap(weight[next], weight[t]);
                 }
-                break;
             }
-        case 4:
-            {
-                auto graph = load_graph_dense<uint64_t, uint64_t, EDGE> (A_ptr, n, graph_idx, run_maxflow);
-                if (run_maxflow) {
-                    alg<vector, uint64_t, uint64_t> M(*graph, source, sink, nthreads);
-                    return M.find_max_flow();
+        }
+    });
+}
+
+
+// Minimum cut found by the last solve of a saved graph with an algorithm of edge_kind (1: basic_edge, 2: cached_edge),
+// read from its residual network. side[v] is 1 for the vertices on the source side, with_edges appends the arcs of
+// positive capacity from the source side to the sink side to edges as pairs of vertices.
+void min_cut(int graph_idx, int mode, int edge_kind, size_t sink, bool with_edges, std::vector<uint8_t>& side, std::vector<uint64_t>& edges) {
+    _with_types(mode, [&](auto vertex_type, auto capacity_type) {
+        using T = decltype(vertex_type);
+        using U = decltype(capacity_type);
+        auto &graph = *std::static_pointer_cast<stored_graph<T, U>> (GraphMap.at(graph_idx));
+        auto cut = [&](const auto& residual) {
+            if (!residual)
+                throw std::invalid_argument("the graph has not been solved with an algorithm of this edge kind");
+            side.resize(residual->size());
+            _min_cut_side(*residual, sink, side);
+            if (!with_edges)
+                return;
+            auto &network = *graph.network;
+            for (size_t v = 0; v < network.size(); ++v) {
+                if (!side[v])
+                    continue;
+                for (auto pos = network.offset(v); pos < network.offset(v + 1); ++pos) {
+                    auto &&arc = network.arc(pos);
+                    if (!side[arc.dst_vertex] && arc.r_capacity > 0) {
+                        edges.push_back(v);
+                        edges.push_back(arc.dst_vertex);
+                    }
                 }
             }
-    }
-    return flow_value;
+        };
+        if (edge_kind == 1)
+            cut(graph.basic_residual);
+        else
+            cut(graph.cached_residual);
+    });
+}
+
+
+// load ( T {}, U {}, run_maxflow ) returns the graph with vertex type T and capacity type U, graph_idx >= 0 selects a
+// saved graph instead.
+template <template <typename, typename> typename EDGE, template <template <typename> typename, typename, typename> typename alg, template <class> typename vector, typename loader>
+std::size_t _run(int mode, int graph_idx, loader load, size_t source, size_t sink, size_t nthreads) {
+    return _with_types(mode, [&](auto vertex_type, auto capacity_type) -> std::size_t {
+        using T = decltype(vertex_type);
+        using U = decltype(capacity_type);
+        if (graph_idx >= 0)
+            return _solve_stored<EDGE, alg, vector>(*std::static_pointer_cast<stored_graph<T, U>> (GraphMap[graph_idx]), source, sink, nthreads);
+        bool run_maxflow;
+        auto graph = load(vertex_type, capacity_type, run_maxflow);
+        if (!run_maxflow)
+            return 0;
+        alg<vector, T, U> M(*graph, source, sink, nthreads);
+        return M.find_max_flow();
+    });
+}
+
+
+template <template <typename, typename> typename EDGE, template <template <typename> typename, typename, typename> typename alg, template <class> typename vector = std::vector>
+size_t _run_dense(int mode, size_t A_ptr, size_t n, size_t source, size_t sink, int graph_idx, size_t nthreads=1) {
+    return _run<EDGE, alg, vector>(mode, graph_idx, [&](auto t, auto u, bool& run_maxflow) {
+        return load_graph_dense<decltype(t), decltype(u), EDGE> (A_ptr, n, graph_idx, run_maxflow, nthreads);
+    }, source, sink, nthreads);
 }
 
 
@@ -123,22 +617,26 @@ std::size_t run_ek_dense(int mode, size_t A_ptr, size_t n, size_t source, size_t
     return _run_dense<basic_edge, edmonds_karp::max_flow_instance, DEFAULT_VECTOR>(mode, A_ptr, n, source, sink, graph_idx);
 }
 
-std::size_t run_prf_dense(int mode, size_t A_ptr, size_t n, size_t source, size_t sink, int graph_idx) {
-    return _run_dense<cached_edge, push_relabel_fifo::max_flow_instance, DEFAULT_VECTOR>(mode, A_ptr, n, source, sink, graph_idx);
+std::size_t run_prf_dense(int mode, size_t A_ptr, size_t n, size_t source, size_t sink, int graph_idx, size_t nthreads) {
+    return _run_dense<cached_edge, push_relabel_fifo::max_flow_instance, DEFAULT_VECTOR>(mode, A_ptr, n, source, sink, graph_idx, nthreads);
 }
 
-std::size_t run_prh_dense(int mode, size_t A_ptr, size_t n, size_t source, size_t sink, int graph_idx) {
-    return _run_dense<cached_edge, push_relabel_highest::max_flow_instance, DEFAULT_VECTOR>(mode, A_ptr, n, source, sink, graph_idx);
+std::size_t run_prh_dense(int mode, size_t A_ptr, size_t n, size_t source, size_t sink, int graph_idx, size_t nthreads) {
+    return _run_dense<cached_edge, push_relabel_highest::max_flow_instance, DEFAULT_VECTOR>(mode, A_ptr, n, source, sink, graph_idx, nthreads);
 }
 
-std::size_t run_ao_dense(int mode, size_t A_ptr, size_t n, size_t source, size_t sink, int graph_idx) {
-    return _run_dense<cached_edge, ahuja_orlin::max_flow_instance, DEFAULT_VECTOR>(mode, A_ptr, n, source, sink, graph_idx);
+std::size_t run_ao_dense(int mode, size_t A_ptr, size_t n, size_t source, size_t sink, int graph_idx, size_t nthreads) {
+    return _run_dense<cached_edge, ahuja_orlin::max_flow_instance, DEFAULT_VECTOR>(mode, A_ptr, n, source, sink, graph_idx, nthreads);
 }
 
 std::size_t run_din_dense(int mode, size_t A_ptr, size_t n, size_t source, size_t sink, int graph_idx) {
     return _run_dense<basic_edge, dinic::max_flow_instance, DEFAULT_VECTOR>(mode, A_ptr, n, source, sink, graph_idx);
 }
 
+std::size_t run_bk_dense(int mode, size_t A_ptr, size_t n, size_t source, size_t sink, int graph_idx) {
+    return _run_dense<basic_edge, boykov_kolmogorov::max_flow_instance, DEFAULT_VECTOR>(mode, A_ptr, n, source, sink, graph_idx);
+}
+
 std::size_t run_ppr_dense(int mode, size_t A_ptr, size_t n, size_t source, size_t sink, int graph_idx, size_t nthreads) {
     return _run_dense<cached_edge, parallel_push_relabel::max_flow_instance, DEFAULT_VECTOR>(mode, A_ptr, n, source, sink, graph_idx, nthreads);
 }
@@ -151,49 +649,16 @@ std::size_t run_paos_dense(int mode, size_t A_ptr, size_t n, size_t source, size
     return _run_dense<cached_edge, ahuja_orlin_segment::max_flow_instance, DEFAULT_VECTOR>(mode, A_ptr, n, source, sink, graph_idx, nthreads);
 }
 
+std::size_t run_apr_dense(int mode, size_t A_ptr, size_t n, size_t source, size_t sink, int graph_idx, size_t nthreads) {
+    return _run_dense<cached_edge, async_push_relabel::max_flow_instance, DEFAULT_VECTOR>(mode, A_ptr, n, source, sink, graph_idx, nthreads);
+}
+
 
 template <template <typename, typename> typename EDGE, template <template <typename> typename, typename, typename> typename alg, template <class> typename vector = std::vector>
 std::size_t _run_sparse(int mode, size_t A_ptr, size_t row_ptr, size_t col_ptr, size_t n, size_t m, size_t source, size_t sink, int graph_idx, size_t nthreads=1) {
-    bool run_maxflow;
-    switch(mode) {
-        case 1: 
-            {
-                auto graph = load_graph_sparse<uint32_t, uint32_t, EDGE> (A_ptr, row_ptr, col_ptr, n, m, graph_idx, run_maxflow);
-                if (run_maxflow) {
-                    alg<vector, uint32_t, uint32_t> M(*graph, source, sink, nthreads);                
-                    return M.find_max_flow();
-                }
-                break;
-            }
-        case 2:
-            {
-                auto graph = load_graph_sparse<uint32_t, uint64_t, EDGE> (A_ptr, row_ptr, col_ptr, n, m, graph_idx, run_maxflow);
-                if (run_maxflow) {
-                    alg<vector, uint32_t, uint64_t> M(*graph, source, sink, nthreads);
-                    return M.find_max_flow();
-                }
-                break;
-            }
-        case 3:
-            {
-                auto graph = load_graph_sparse<uint64_t, uint32_t, EDGE> (A_ptr, row_ptr, col_ptr, n, m, graph_idx, run_maxflow);
-                if (run_maxflow) {
-                    alg<vector, uint64_t, uint32_t> M(*graph, source, sink, nthreads);
-                    return M.find_max_flow();
-                }
-                break;
-            }
-        case 4:
-            {
-                auto graph = load_graph_sparse<uint64_t, uint64_t, EDGE> (A_ptr, row_ptr, col_ptr, n, m, graph_idx, run_maxflow);
-                if (run_maxflow) {
-                    alg<vector, uint64_t, uint64_t> M(*graph, source, sink, nthreads);
-                    return M.find_max_flow();
-                }
-                break;
-            }
-    }
-    return 0;
+    return _run<EDGE, alg, vector>(mode, graph_idx, [&](auto t, auto u, bool& run_maxflow) {
+        return load_graph_sparse<decltype(t), decltype(u), EDGE> (A_ptr, row_ptr, col_ptr, n, m, graph_idx, run_maxflow, nthreads);
+    }, source, sink, nthreads);
 }
 
 
@@ -201,22 +666,26 @@ std::size_t run_ek_sparse(int mode, size_t A_ptr, size_t row_ptr, size_t col_ptr
     return _run_sparse<basic_edge, edmonds_karp::max_flow_instance, DEFAULT_VECTOR>(mode, A_ptr, row_ptr, col_ptr, n, m, source, sink, graph_idx);
 }
 
-std::size_t run_prf_sparse(int mode, size_t A_ptr, size_t row_ptr, size_t col_ptr, size_t n, size_t m, size_t source, size_t sink, int graph_idx) {
-    return _run_sparse<cached_edge, push_relabel_fifo::max_flow_instance, DEFAULT_VECTOR>(mode, A_ptr, row_ptr, col_ptr, n, m, source, sink, graph_idx);
+std::size_t run_prf_sparse(int mode, size_t A_ptr, size_t row_ptr, size_t col_ptr, size_t n, size_t m, size_t source, size_t sink, int graph_idx, size_t nthreads) {
+    return _run_sparse<cached_edge, push_relabel_fifo::max_flow_instance, DEFAULT_VECTOR>(mode, A_ptr, row_ptr, col_ptr, n, m, source, sink, graph_idx, nthreads);
 }
 
-std::size_t run_prh_sparse(int mode, size_t A_ptr, size_t row_ptr, size_t col_ptr, size_t n, size_t m, size_t source, size_t sink, int graph_idx) {
-    return _run_sparse<cached_edge, push_relabel_highest::max_flow_instance, DEFAULT_VECTOR>(mode, A_ptr, row_ptr, col_ptr, n, m, source, sink, graph_idx);
+std::size_t run_prh_sparse(int mode, size_t A_ptr, size_t row_ptr, size_t col_ptr, size_t n, size_t m, size_t source, size_t sink, int graph_idx, size_t nthreads) {
+    return _run_sparse<cached_edge, push_relabel_highest::max_flow_instance, DEFAULT_VECTOR>(mode, A_ptr, row_ptr, col_ptr, n, m, source, sink, graph_idx, nthreads);
 }
 
-std::size_t run_ao_sparse(int mode, size_t A_ptr, size_t row_ptr, size_t col_ptr, size_t n, size_t m, size_t source, size_t sink, int graph_idx) {
-    return _run_sparse<cached_edge, ahuja_orlin::max_flow_instance, DEFAULT_VECTOR>(mode, A_ptr, row_ptr, col_ptr, n, m, source, sink, graph_idx);
+std::size_t run_ao_sparse(int mode, size_t A_ptr, size_t row_ptr, size_t col_ptr, size_t n, size_t m, size_t source, size_t sink, int graph_idx, size_t nthreads) {
+    return _run_sparse<cached_edge, ahuja_orlin::max_flow_instance, DEFAULT_VECTOR>(mode, A_ptr, row_ptr, col_ptr, n, m, source, sink, graph_idx, nthreads);
 }
 
 std::size_t run_din_sparse(int mode, size_t A_ptr, size_t row_ptr, size_t col_ptr, size_t n, size_t m, size_t source, size_t sink, int graph_idx) {
     return _run_sparse<basic_edge, dinic::max_flow_instance, DEFAULT_VECTOR>(mode, A_ptr, row_ptr, col_ptr, n, m, source, sink, graph_idx);
 }
 
+std::size_t run_bk_sparse(int mode, size_t A_ptr, size_t row_ptr, size_t col_ptr, size_t n, size_t m, size_t source, size_t sink, int graph_idx) {
+    return _run_sparse<basic_edge, boykov_kolmogorov::max_flow_instance, DEFAULT_VECTOR>(mode, A_ptr, row_ptr, col_ptr, n, m, source, sink, graph_idx);
+}
+
 std::size_t run_ppr_sparse(int mode, size_t A_ptr, size_t row_ptr, size_t col_ptr, size_t n, size_t m, size_t source, size_t sink, int graph_idx, size_t nthreads) {
     return _run_sparse<cached_edge, parallel_push_relabel::max_flow_instance, DEFAULT_VECTOR>(mode, A_ptr, row_ptr, col_ptr, n, m, source, sink, graph_idx, nthreads);
 }
@@ -228,3 +697,208 @@ std::size_t run_pprs_sparse(int mode, size_t A_ptr, size_t row_ptr, size_t col_p
 std::size_t run_paos_sparse(int mode, size_t A_ptr, size_t row_ptr, size_t col_ptr, size_t n, size_t m, size_t source, size_t sink, int graph_idx, size_t nthreads) {
     return _run_sparse<cached_edge, ahuja_orlin_segment::max_flow_instance, DEFAULT_VECTOR>(mode, A_ptr, row_ptr, col_ptr, n, m, source, sink, graph_idx, nthreads);
 }
+
+std::size_t run_apr_sparse(int mode, size_t A_ptr, size_t row_ptr, size_t col_ptr, size_t n, size_t m, size_t source, size_t sink, int graph_idx, size_t nthreads) {
+    return _run_sparse<cached_edge, async_push_relabel::max_flow_instance, DEFAULT_VECTOR>(mode, A_ptr, row_ptr, col_ptr, n, m, source, sink, graph_idx, nthreads);
+}
+
+
+template <template <typename, typename> typename EDGE, template <template <typename> typename, typename, typename> typename alg, template <class> typename vector = std::vector>
+std::size_t _run_csr(int mode, size_t A_ptr, size_t indptr_ptr, size_t indices_ptr, size_t n, bool index64, bool transposed, size_t source, size_t sink, int graph_idx, size_t nthreads=1) {
+    return _run<EDGE, alg, vector>(mode, graph_idx, [&](auto t, auto u, bool& run_maxflow) {
+        return load_graph_csr<decltype(t), decltype(u), EDGE> (A_ptr, indptr_ptr, indices_ptr, n, index64, transposed, graph_idx, run_maxflow, nthreads);
+    }, source, sink, nthreads);
+}
+
+
+std::size_t run_ek_csr(int mode, size_t A_ptr, size_t indptr_ptr, size_t indices_ptr, size_t n, bool index64, bool transposed, size_t source, size_t sink, int graph_idx) {
+    return _run_csr<basic_edge, edmonds_karp::max_flow_instance, DEFAULT_VECTOR>(mode, A_ptr, indptr_ptr, indices_ptr, n, index64, transposed, source, sink, graph_idx);
+}
+
+std::size_t run_prf_csr(int mode, size_t A_ptr, size_t indptr_ptr, size_t indices_ptr, size_t n, bool index64, bool transposed, size_t source, size_t sink, int graph_idx, size_t nthreads) {
+    return _run_csr<cached_edge, push_relabel_fifo::max_flow_instance, DEFAULT_VECTOR>(mode, A_ptr, indptr_ptr, indices_ptr, n, index64, transposed, source, sink, graph_idx, nthreads);
+}
+
+std::size_t run_prh_csr(int mode, size_t A_ptr, size_t indptr_ptr, size_t indices_ptr, size_t n, bool index64, bool transposed, size_t source, size_t sink, int graph_idx, size_t nthreads) {
+    return _run_csr<cached_edge, push_relabel_highest::max_flow_instance, DEFAULT_VECTOR>(mode, A_ptr, indptr_ptr, indices_ptr, n, index64, transposed, source, sink, graph_idx, nthreads);
+}
+
+std::size_t run_ao_csr(int mode, size_t A_ptr, size_t indptr_ptr, size_t indices_ptr, size_t n, bool index64, bool transposed, size_t source, size_t sink, int graph_idx, size_t nthreads) {
+    return _run_csr<cached_edge, ahuja_orlin::max_flow_instance, DEFAULT_VECTOR>(mode, A_ptr, indptr_ptr, indices_ptr, n, index64, transposed, source, sink, graph_idx, nthreads);
+}
+
+std::size_t run_din_csr(int mode, size_t A_ptr, size_t indptr_ptr, size_t indices_ptr, size_t n, bool index64, bool transposed, size_t source, size_t sink, int graph_idx) {
+    return _run_csr<basic_edge, dinic::max_flow_instance, DEFAULT_VECTOR>(mode, A_ptr, indptr_ptr, indices_ptr, n, index64, transposed, source, sink, graph_idx);
+}
+
+std::size_t run_bk_csr(int mode, size_t A_ptr, size_t indptr_ptr, size_t indices_ptr, size_t n, bool index64, bool transposed, size_t source, size_t sink, int graph_idx) {
+    return _run_csr<basic_edge, boykov_kolmogorov::max_flow_instance, DEFAULT_VECTOR>(mode, A_ptr, indptr_ptr, indices_ptr, n, index64, transposed, source, sink, graph_idx);
+}
+
+std::size_t run_ppr_csr(int mode, size_t A_ptr, size_t indptr_ptr, size_t indices_ptr, size_t n, bool index64, bool transposed, size_t source, size_t sink, int graph_idx, size_t nthreads) {
+    return _run_csr<cached_edge, parallel_push_relabel::max_flow_instance, DEFAULT_VECTOR>(mode, A_ptr, indptr_ptr, indices_ptr, n, index64, transposed, source, sink, graph_idx, nthreads);
+}
+
+std::size_t run_pprs_csr(int mode, size_t A_ptr, size_t indptr_ptr, size_t indices_ptr, size_t n, bool index64, bool transposed, size_t source, size_t sink, int graph_idx, size_t nthreads) {
+    return _run_csr<cached_edge, push_relabel_segment::max_flow_instance, DEFAULT_VECTOR>(mode, A_ptr, indptr_ptr, indices_ptr, n, index64, transposed, source, sink, graph_idx, nthreads);
+}
+
+std::size_t run_paos_csr(int mode, size_t A_ptr, size_t indptr_ptr, size_t indices_ptr, size_t n, bool index64, bool transposed, size_t source, size_t sink, int graph_idx, size_t nthreads) {
+    return _run_csr<cached_edge, ahuja_orlin_segment::max_flow_instance, DEFAULT_VECTOR>(mode, A_ptr, indptr_ptr, indices_ptr, n, index64, transposed, source, sink, graph_idx, nthreads);
+}
+
+std::size_t run_apr_csr(int mode, size_t A_ptr, size_t indptr_ptr, size_t indices_ptr, size_t n, bool index64, bool transposed, size_t source, size_t sink, int graph_idx, size_t nthreads) {
+    return _run_csr<cached_edge, async_push_relabel::max_flow_instance, DEFAULT_VECTOR>(mode, A_ptr, indptr_ptr, indices_ptr, n, index64, transposed, source, sink, graph_idx, nthreads);
+}
+
+void run_ek_many(int mode, int graph_idx, size_t sources_ptr, size_t sinks_ptr, size_t k, size_t flows_ptr, size_t nthreads) {
+    _solve_many<basic_edge, edmonds_karp::max_flow_instance, DEFAULT_VECTOR>(mode, graph_idx, sources_ptr, sinks_ptr, k, flows_ptr, nthreads);
+}
+
+void run_prf_many(int mode, int graph_idx, size_t sources_ptr, size_t sinks_ptr, size_t k, size_t flows_ptr, size_t nthreads) {
+    _solve_many<cached_edge, push_relabel_fifo::max_flow_instance, DEFAULT_VECTOR>(mode, graph_idx, sources_ptr, sinks_ptr, k, flows_ptr, nthreads);
+}
+
+void run_prh_many(int mode, int graph_idx, size_t sources_ptr, size_t sinks_ptr, size_t k, size_t flows_ptr, size_t nthreads) {
+    _solve_many<cached_edge, push_relabel_highest::max_flow_instance, DEFAULT_VECTOR>(mode, graph_idx, sources_ptr, sinks_ptr, k, flows_ptr, nthreads);
+}
+
+void run_ao_many(int mode, int graph_idx, size_t sources_ptr, size_t sinks_ptr, size_t k, size_t flows_ptr, size_t nthreads) {
+    _solve_many<cached_edge, ahuja_orlin::max_flow_instance, DEFAULT_VECTOR>(mode, graph_idx, sources_ptr, sinks_ptr, k, flows_ptr, nthreads);
+}
+
+void run_din_many(int mode, int graph_idx, size_t sources_ptr, size_t sinks_ptr, size_t k, size_t flows_ptr, size_t nthreads) {
+    _solve_many<basic_edge, dinic::max_flow_instance, DEFAULT_VECTOR>(mode, graph_idx, sources_ptr, sinks_ptr, k, flows_ptr, nthreads);
+}
+
+void run_bk_many(int mode, int graph_idx, size_t sources_ptr, size_t sinks_ptr, size_t k, size_t flows_ptr, size_t nthreads) {
+    _solve_many<basic_edge, boykov_kolmogorov::max_flow_instance, DEFAULT_VECTOR>(mode, graph_idx, sources_ptr, sinks_ptr, k, flows_ptr, nthreads);
+}
+
+void run_ppr_many(int mode, int graph_idx, size_t sources_ptr, size_t sinks_ptr, size_t k, size_t flows_ptr, size_t nthreads) {
+    _solve_many<cached_edge, parallel_push_relabel::max_flow_instance, DEFAULT_VECTOR>(mode, graph_idx, sources_ptr, sinks_ptr, k, flows_ptr, nthreads, true);
+}
+
+void run_pprs_many(int mode, int graph_idx, size_t sources_ptr, size_t sinks_ptr, size_t k, size_t flows_ptr, size_t nthreads) {
+    _solve_many<cached_edge, push_relabel_segment::max_flow_instance, DEFAULT_VECTOR>(mode, graph_idx, sources_ptr, sinks_ptr, k, flows_ptr, nthreads, true);
+}
+
+void run_paos_many(int mode, int graph_idx, size_t sources_ptr, size_t sinks_ptr, size_t k, size_t flows_ptr, size_t nthreads) {
+    _solve_many<cached_edge, ahuja_orlin_segment::max_flow_instance, DEFAULT_VECTOR>(mode, graph_idx, sources_ptr, sinks_ptr, k, flows_ptr, nthreads, true);
+}
+
+void run_apr_many(int mode, int graph_idx, size_t sources_ptr, size_t sinks_ptr, size_t k, size_t flows_ptr, size_t nthreads) {
+    _solve_many<cached_edge, async_push_relabel::max_flow_instance, DEFAULT_VECTOR>(mode, graph_idx, sources_ptr, sinks_ptr, k, flows_ptr, nthreads, true);
+}
+
+void run_ek_gomory_hu(int mode, int graph_idx, size_t parent_ptr, size_t weight_ptr, size_t nthreads) {
+    _gomory_hu<basic_edge, edmonds_karp::max_flow_instance, DEFAULT_VECTOR>(mode, graph_idx, parent_ptr, weight_ptr, nthreads);
+}
+
+void run_prf_gomory_hu(int mode, int graph_idx, size_t parent_ptr, size_t weight_ptr, size_t nthreads) {
+    _gomory_hu<cached_edge, push_relabel_fifo::max_flow_instance, DEFAULT_VECTOR>(mode, graph_idx, parent_ptr, weight_ptr, nthreads);
+}
+
+void run_prh_gomory_hu(int mode, int graph_idx, size_t parent_ptr, size_t weight_ptr, size_t nthreads) {
+    _gomory_hu<cached_edge, push_relabel_highest::max_flow_instance, DEFAULT_VECTOR>(mode, graph_idx, parent_ptr, weight_ptr, nthreads);
+}
+
+void run_ao_gomory_hu(int mode, int graph_idx, size_t parent_ptr, size_t weight_ptr, size_t nthreads) {
+    _gomory_hu<cached_edge, ahuja_orlin::max_flow_instance, DEFAULT_VECTOR>(mode, graph_idx, parent_ptr, weight_ptr, nthreads);
+}
+
+void run_din_gomory_hu(int mode, int graph_idx, size_t parent_ptr, size_t weight_ptr, size_t nthreads) {
+    _gomory_hu<basic_edge, dinic::max_flow_instance, DEFAULT_VECTOR>(mode, graph_idx, parent_ptr, weight_ptr, nthreads);
+}
+
+void run_bk_gomory_hu(int mode, int graph_idx, size_t parent_ptr, size_t weight_ptr, size_t nthreads) {
+    _gomory_hu<basic_edge, boykov_kolmogorov::max_flow_instance, DEFAULT_VECTOR>(mode, graph_idx, parent_ptr, weight_ptr, nthreads);
+}
+
+void run_ppr_gomory_hu(int mode, int graph_idx, size_t parent_ptr, size_t weight_ptr, size_t nthreads) {
+    _gomory_hu<cached_edge, parallel_push_relabel::max_flow_instance, DEFAULT_VECTOR>(mode, graph_idx, parent_ptr, weight_ptr, nthreads, true);
+}
+
+void run_pprs_gomory_hu(int mode, int graph_idx, size_t parent_ptr, size_t weight_ptr, size_t nthreads) {
+    _gomory_hu<cached_edge, push_relabel_segment::max_flow_instance, DEFAULT_VECTOR>(mode, graph_idx, parent_ptr, weight_ptr, nthreads, true);
+}
+
+void run_paos_gomory_hu(int mode, int graph_idx, size_t parent_ptr, size_t weight_ptr, size_t nthreads) {
+    _gomory_hu<cached_edge, ahuja_orlin_segment::max_flow_instance, DEFAULT_VECTOR>(mode, graph_idx, parent_ptr, weight_ptr, nthreads, true);
+}
+
+void run_apr_gomory_hu(int mode, int graph_idx, size_t parent_ptr, size_t weight_ptr, size_t nthreads) {
+    _gomory_hu<cached_edge, async_push_relabel::max_flow_instance, DEFAULT_VECTOR>(mode, graph_idx, parent_ptr, weight_ptr, nthreads, true);
+}
+
+std::size_t run_ek_flow(int mode, int graph_idx, size_t source, size_t sink, size_t flows_ptr, size_t nthreads) {
+    return _solve_flow<basic_edge, edmonds_karp::max_flow_instance, DEFAULT_VECTOR>(mode, graph_idx, source, sink, flows_ptr, nthreads);
+}
+
+std::size_t run_prf_flow(int mode, int graph_idx, size_t source, size_t sink, size_t flows_ptr, size_t nthreads) {
+    return _solve_flow<cached_edge, push_relabel_fifo::max_flow_instance, DEFAULT_VECTOR>(mode, graph_idx, source, sink, flows_ptr, nthreads);
+}
+
+std::size_t run_prh_flow(int mode, int graph_idx, size_t source, size_t sink, size_t flows_ptr, size_t nthreads) {
+    return _solve_flow<cached_edge, push_relabel_highest::max_flow_instance, DEFAULT_VECTOR>(mode, graph_idx, source, sink, flows_ptr, nthreads);
+}
+
+std::size_t run_ao_flow(int mode, int graph_idx, size_t source, size_t sink, size_t flows_ptr, size_t nthreads) {
+    return _solve_flow<cached_edge, ahuja_orlin::max_flow_instance, DEFAULT_VECTOR>(mode, graph_idx, source, sink, flows_ptr, nthreads);
+}
+
+std::size_t run_din_flow(int mode, int graph_idx, size_t source, size_t sink, size_t flows_ptr, size_t nthreads) {
+    return _solve_flow<basic_edge, dinic::max_flow_instance, DEFAULT_VECTOR>(mode, graph_idx, source, sink, flows_ptr, nthreads);
+}
+
+std::size_t run_bk_flow(int mode, int graph_idx, size_t source, size_t sink, size_t flows_ptr, size_t nthreads) {
+    return _solve_flow<basic_edge, boykov_kolmogorov::max_flow_instance, DEFAULT_VECTOR>(mode, graph_idx, source, sink, flows_ptr, nthreads);
+}
+
+std::size_t run_ppr_flow(int mode, int graph_idx, size_t source, size_t sink, size_t flows_ptr, size_t nthreads) {
+    return _solve_flow<cached_edge, parallel_push_relabel::max_flow_instance, DEFAULT_VECTOR>(mode, graph_idx, source, sink, flows_ptr, nthreads);
+}
+
+std::size_t run_pprs_flow(int mode, int graph_idx, size_t source, size_t sink, size_t flows_ptr, size_t nthreads) {
+    return _solve_flow<cached_edge, push_relabel_segment::max_flow_instance, DEFAULT_VECTOR>(mode, graph_idx, source, sink, flows_ptr, nthreads);
+}
+
+std::size_t run_paos_flow(int mode, int graph_idx, size_t source, size_t sink, size_t flows_ptr, size_t nthreads) {
+    return _solve_flow<cached_edge, ahuja_orlin_segment::max_flow_instance, DEFAULT_VECTOR>(mode, graph_idx, source, sink, flows_ptr, nthreads);
+}
+
+std::size_t run_apr_flow(int mode, int graph_idx, size_t source, size_t sink, size_t flows_ptr, size_t nthreads) {
+    return _solve_flow<cached_edge, async_push_relabel::max_flow_instance, DEFAULT_VECTOR>(mode, graph_idx, source, sink, flows_ptr, nthreads);
+}
+
+
+// Solves the lattice described by _load_graph_grid, with the source and the sink after the pixels, without building
+// its adjacency. If side_ptr is not 0, side[p] is set to 1 for the pixels p on the source side of a minimum cut.
+template <template <typename, typename> typename EDGE, template <template <typename> typename, typename, typename> typename alg>
+std::size_t _run_grid(int mode, size_t capacities_ptr, size_t terminals_ptr, size_t nx, size_t ny, size_t nz, size_t neighbours, size_t side_ptr, size_t nthreads) {
+    return _with_types(mode, [&](auto vertex_type, auto capacity_type) -> std::size_t {
+        using T = decltype(vertex_type);
+        using U = decltype(capacity_type);
+        auto graph = _load_graph_grid<T, U, EDGE>((const U*) capacities_ptr, (const U*) terminals_ptr, nx, ny, nz, neighbours, nthreads);
+        alg<data_structures::grid, T, U> M(*graph, graph->source(), graph->sink(), nthreads);
+        const std::size_t flow = M.find_max_flow();
+        if (side_ptr) {
+            std::vector<uint8_t> side(graph->size());
+            _min_cut_side(*graph, graph->sink(), side);
+            std::copy_n(side.begin(), graph->pixel_count(), (uint8_t*) side_ptr);
+        }
+        return flow;
+    });
+}
+
+std::size_t run_prh_grid(int mode, size_t capacities_ptr, size_t terminals_ptr, size_t nx, size_t ny, size_t nz, size_t neighbours, size_t side_ptr, size_t nthreads) {
+    return _run_grid<cached_edge, push_relabel_highest::max_flow_instance>(mode, capacities_ptr, terminals_ptr, nx, ny, nz, neighbours, side_ptr, nthreads);
+}
+
+std::size_t run_bk_grid(int mode, size_t capacities_ptr, size_t terminals_ptr, size_t nx, size_t ny, size_t nz, size_t neighbours, size_t side_ptr, size_t nthreads) {
+    return _run_grid<basic_edge, boykov_kolmogorov::max_flow_instance>(mode, capacities_ptr, terminals_ptr, nx, ny, nz, neighbours, side_ptr, nthreads);
+}
+
+std::size_t run_ppr_grid(int mode, size_t capacities_ptr, size_t terminals_ptr, size_t nx, size_t ny, size_t nz, size_t neighbours, size_t side_ptr, size_t nthreads) {
+    return _run_grid<cached_edge, parallel_push_relabel::max_flow_instance>(mode, capacities_ptr, terminals_ptr, nx, ny, nz, neighbours, side_ptr, nthreads);
+}
@@ -51,6 +51,8 @@ def test_correctness(n, iters, seed=0, density=0.5, dense=True):
         fns_name.remove('_maxflow')
         fns_name.remove('maxflow')
         fns_name.remove('get_alg_names')
+        fns_name.remove('gomory_hu')
+        fns_name.remove('grid')
     except Exception as e:
         pass
     fns = [eval('maxflow.'+i) for i in fns_name]
@@ -90,6 +92,52 @@ def test_correctness(n, iters, seed=0, density=0.5, dense=True):
 
 
 
+def test_correctness_memmap(n, iters, seed=0, density=0.5):
+    print("------------Running test_correctness_memmap!--------------")
+    print("n={}, iters={}, density={}".format(n, iters, density))
+    import tempfile, os
+    np.random.seed(seed)
+    alg_names = maxflow.get_alg_names()
+
+    with tempfile.TemporaryDirectory() as tmp_dir:
+        for i in range(iters):
+            x = (sparse.rand(n,n,density=density,format='csr')*200).astype(np.uint32)
+            flow = sparse.csgraph.maximum_flow(x, 0, n-1).flow_value
+            x_ = np.memmap(os.path.join(tmp_dir, "A{}.bin".format(i)), dtype=np.uint32, mode='w+', shape=(n,n))
+            x_[:] = x.toarray()
+            x_.flush()
+            x_ = np.memmap(x_.filename, dtype=np.uint32, mode='r', shape=(n,n))
+            for alg in alg_names:
+                fn = getattr(maxflow, alg)
+                flow2 = fn(x_, 0, n-1, THREADS) if 'parallel' in alg else fn(x_, 0, n-1)
+                assert flow == flow2, "Error at iteration:{}! : function {} gives flow:{}, while scipy's maxflow:{}".format(i, alg, flow2, flow)
+            del x_
+
+
+def test_correctness_sparse_formats(n, iters, seed=0, density=0.5):
+    print("------------Running test_correctness_sparse_formats!--------------")
+    print("n={}, iters={}, density={}".format(n, iters, density))
+    np.random.seed(seed)
+    alg_names = maxflow.get_alg_names()
+
+    for i in range(iters):
+        x = (sparse.rand(n,n,density=density,format='csr')*200).astype(np.uint32)
+        flow = sparse.csgraph.maximum_flow(x, 0, n-1).flow_value
+        # csc, csr with int64 indices, and csr with every entry split into two unsorted duplicates
+        rows = [slice(x.indptr[r], x.indptr[r+1]) for r in range(n)]
+        dup_indices = np.concatenate([np.concatenate([x.indices[r][::-1], x.indices[r]]) for r in rows])
+        dup_data = np.concatenate([np.concatenate([x.data[r][::-1] // 2, x.data[r] - x.data[r] // 2]) for r in rows])
+        x_dup = sparse.csr_matrix((dup_data, dup_indices, 2 * x.indptr), shape=(n,n))
+        assert not x_dup.has_canonical_format
+        x_64 = x.copy()
+        x_64.indptr, x_64.indices = x_64.indptr.astype(np.int64), x_64.indices.astype(np.int64)
+        for x_ in [x.tocsc(), x_64, x_dup]:
+            for alg in alg_names:
+                fn = getattr(maxflow, alg)
+                flow2 = fn(x_, 0, n-1, THREADS) if 'parallel' in alg else fn(x_, 0, n-1)
+                assert flow == flow2, "Error at iteration:{}! : function {} on {} gives flow:{}, while scipy's maxflow:{}".format(i, alg, type(x_).__name__, flow2, flow)
+
+
 def bench(n, iters, seed=0, density=0.5, dense=True, matrix_generator=gen_matrix1):
     print("------------Running bench!--------------")
     print("n={}, iters={}, density={}, dense={}".format(n, iters, density, dense))
@@ -99,6 +147,8 @@ def bench(n, iters, seed=0, density=0.5, dense=True, matrix_generator=gen_matrix
         fns_name.remove('_maxflow')
         fns_name.remove('maxflow')
         fns_name.remove('get_alg_names')
+        fns_name.remove('gomory_hu')
+        fns_name.remove('grid')
     except Exception as e:
         pass
     fns = [eval('maxflow.'+i) for i in fns_name]
@@ -155,6 +205,12 @@ def test_correctness_Solver(n, iters, seed=0, density=0.5, dense=True):
             flow2 = S.solve(alg, 0, n-1, THREADS)
             assert flow == flow2, "Error at iteration:{}! : function {} gives flow:{}, while scipy's maxflow:{}".format(i, alg, flow2, flow)
 
+        # a graph loaded once is solved by every algorithm
+        S.load_graph(x_, nthreads=THREADS)
+        for alg in alg_names:
+            flow2 = S.solve(alg, 0, n-1, THREADS)
+            assert flow == flow2, "Error at iteration:{}! : function {} on a shared graph gives flow:{}, while scipy's maxflow:{}".format(i, alg, flow2, flow)
+
         x = (sparse.rand(n,n,density=density,format='csr')*2**30).astype(np.uint64)
         flow = sparse.csgraph.maximum_flow(x, 0, n-1).flow_value
         # flow_or = computeFlow(genMaxFlow(x_), n)
@@ -169,6 +225,310 @@ def test_correctness_Solver(n, iters, seed=0, density=0.5, dense=True):
             assert flow == flow2, "Error at iteration:{}! : function {} gives flow:{}, while scipy's maxflow:{}, Google's maxflow:{}".format(i, alg, flow2, flow, flow_or)
 
 
+def test_correctness_gomory_hu(n, iters, queries, seed=0, density=0.2):
+    print("------------Running test_correctness_gomory_hu!--------------")
+    print("n={}, iters={}, queries={}, density={}".format(n, iters, queries, density))
+    np.random.seed(seed)
+    alg_names = maxflow.get_alg_names()
+
+    for i in range(iters):
+        x = (sparse.rand(n,n,density=density,format='csr')*100).astype(np.uint32)
+        x = (x + x.T).tocsr()
+        terminals = [tuple(int(v) for v in np.random.choice(n, 2, replace=False)) for q in range(queries)]
+        flows = [sparse.csgraph.maximum_flow(x, s, t).flow_value for s, t in terminals]
+        for alg in alg_names:
+            for x_ in [x, x.toarray()]:
+                parent, weight = maxflow.gomory_hu(x_, alg, THREADS)
+                assert parent[0] == -1 and sorted(np.flatnonzero(parent == -1)) == [0]
+                # the maximum flow between two vertices is the smallest weight on their tree path
+                for (s, t), flow in zip(terminals, flows):
+                    path_s, path_t = [s], [t]
+                    while path_s[-1] != 0:
+                        path_s.append(int(parent[path_s[-1]]))
+                    while path_t[-1] != 0:
+                        path_t.append(int(parent[path_t[-1]]))
+                    common = set(path_s) & set(path_t)
+                    edges = [v for v in path_s if v not in common] + [v for v in path_t if v not in common]
+                    flow2 = min(int(weight[v]) for v in edges)
+                    assert flow == flow2, "Error at iteration:{}! : gomory_hu with {} gives flow:{} for query {}, while scipy's maxflow:{}".format(i, alg, flow2, (s, t), flow)
+                # removing the edge v - parent[v] splits the vertices into a cut of capacity weight[v]
+                for v in range(1, n):
+                    below = np.zeros(n, dtype=bool)
+                    for u in range(n):
+                        path = [u]
+                        while path[-1] != v and path[-1] != 0:
+                            path.append(int(parent[path[-1]]))
+                        below[u] = path[-1] == v
+                    cut = x[below][:, ~below].sum()
+                    assert cut == weight[v], "Error at iteration:{}! : gomory_hu with {} gives the tree edge {} of weight:{}, which splits a cut of capacity {}".format(i, alg, (v, int(parent[v])), weight[v], cut)
+
+    try:
+        maxflow.gomory_hu(np.triu(np.ones((n,n), dtype=np.uint32)), alg_names[0])
+        assert False, "gomory_hu accepted an asymmetric matrix"
+    except ValueError:
+        pass
+
+
+def test_correctness_grid(iters, seed=0):
+    print("------------Running test_correctness_grid!--------------")
+    print("iters={}".format(iters))
+    np.random.seed(seed)
+    alg_names = ['push_relabel_highest', 'boykov_kolmogorov', 'parallel_push_relabel']
+
+    for i in range(iters):
+        for K in (4, 8, 6, 26):
+            shape = tuple(np.random.randint(1, 8, size=2 if K in (4, 8) else 3))
+            capacities = np.random.randint(0, 50, size=(K,) + shape).astype(np.uint32)
+            terminal_caps = np.random.randint(0, 100, size=(2,) + shape).astype(np.uint32)
+            # the same lattice as a matrix, the source and the sink after the pixels
+            N = int(np.prod(shape))
+            grids = np.indices(shape).reshape(len(shape), N)
+            offsets = [d for d in np.ndindex(*(3,) * len(shape)) if any(c != 1 for c in d)]
+            offsets = [d for d in offsets if K in (8, 26) or sum(c != 1 for c in d) == 1]
+            rows, cols, data = [np.full(N, N), np.arange(N)], [np.arange(N), np.full(N, N + 1)], list(terminal_caps.reshape(2, N))
+            for k, d in enumerate(offsets):
+                heads = grids + np.array(d).reshape(-1, 1) - 1
+                inside = np.all((heads >= 0) & (heads < np.array(shape).reshape(-1, 1)), axis=0)
+                rows.append(np.arange(N)[inside])
+                cols.append(np.ravel_multi_index(tuple(heads[:, inside]), shape))
+                data.append(capacities[k].reshape(N)[inside])
+            x = sparse.csr_matrix((np.concatenate(data), (np.concatenate(rows), np.concatenate(cols))), shape=(N + 2, N + 2))
+            flow = sparse.csgraph.maximum_flow(x, N, N + 1).flow_value
+            for alg in alg_names:
+                flow2, mask = maxflow.grid(capacities, terminal_caps, alg, THREADS, return_cut=True)
+                side = np.concatenate([mask.reshape(N), [True, False]])
+                cut = x[side][:, ~side].sum()
+                assert flow == flow2 == cut, "Error at iteration:{}! : grid with {} and {} neighbours gives flow:{} and a cut of capacity {}, while scipy's maxflow:{}".format(i, alg, K, flow2, cut, flow)
+
+
+def test_correctness_queries(n, iters, queries, seed=0, density=0.5):
+    print("------------Running test_correctness_queries!--------------")
+    print("n={}, iters={}, queries={}, density={}".format(n, iters, queries, density))
+    np.random.seed(seed)
+    alg_names = maxflow.get_alg_names()
+    S = maxflow.Solver()
+
+    for i in range(iters):
+        x = (sparse.rand(n,n,density=density,format='csr')*200).astype(np.uint32)
+        S.load_graph(x)
+        # every solve must start from the loaded capacities
+        for q in range(queries):
+            source, sink = (int(v) for v in np.random.choice(n, 2, replace=False))
+            flow = sparse.csgraph.maximum_flow(x, source, sink).flow_value
+            for alg in alg_names:
+                flow2 = S.solve(alg, source, sink, THREADS)
+                assert flow == flow2, "Error at iteration:{}! : function {} gives flow:{} for query {}, while scipy's maxflow:{}".format(i, alg, flow2, (source, sink), flow)
+
+
+def test_correctness_cut(n, iters, seed=0, density=0.5):
+    print("------------Running test_correctness_cut!--------------")
+    print("n={}, iters={}, density={}".format(n, iters, density))
+    np.random.seed(seed)
+    alg_names = maxflow.get_alg_names()
+    S = maxflow.Solver()
+
+    for i in range(iters):
+        x = (sparse.rand(n,n,density=density,format='csr')*200).astype(np.uint32)
+        S.load_graph(x)
+        source, sink = (int(v) for v in np.random.choice(n, 2, replace=False))
+        flow = sparse.csgraph.maximum_flow(x, source, sink).flow_value
+        for alg in alg_names:
+            flow2, mask, edges = S.solve(alg, source, sink, THREADS, cut_edges=True)
+            assert mask.dtype == bool and not mask.flags.owndata, "the cut mask must wrap the solver's buffer"
+            assert mask[source] and not mask[sink], "Error at iteration:{}! : function {} puts a terminal on the wrong side".format(i, alg)
+            crossing = x[mask][:, ~mask].tocoo()
+            crossing.eliminate_zeros()
+            expected = sorted(zip(np.flatnonzero(mask)[crossing.row], np.flatnonzero(~mask)[crossing.col]))
+            assert sorted(map(tuple, edges.tolist())) == expected, "Error at iteration:{}! : function {} gives wrong cut edges".format(i, alg)
+            assert flow == flow2 == crossing.sum(), "Error at iteration:{}! : function {} gives flow:{} and a cut of capacity {}, while scipy's maxflow:{}".format(i, alg, flow2, crossing.sum(), flow)
+
+            fn = getattr(maxflow, alg)
+            flow3, mask3 = fn(x, source, sink, THREADS, return_cut=True) if 'parallel' in alg else fn(x, source, sink, return_cut=True)
+            assert flow3 == flow and x[mask3][:, ~mask3].sum() == flow, "Error at iteration:{}! : function {} gives a wrong cut".format(i, alg)
+
+
+def check_flow(F, x, source, sink, flow, name):
+    # F must hold a feasible flow of value flow on the entries of x
+    F, x = sparse.csr_matrix(F, dtype=np.int64), sparse.csr_matrix(x, dtype=np.int64)
+    assert np.all(F.data >= 0) and (x - F).min() >= 0, "{} : flows exceed the capacities".format(name)
+    net = np.asarray(F.sum(axis=1)).ravel() - np.asarray(F.sum(axis=0)).ravel()
+    assert net[source] == flow and net[sink] == -flow, "{} : flow value {} differs from the flow leaving the source {}".format(name, flow, net[source])
+    net[[source, sink]] = 0
+    assert not np.any(net), "{} : flow is not conserved".format(name)
+
+
+def test_correctness_flow(n, iters, seed=0, density=0.5):
+    print("------------Running test_correctness_flow!--------------")
+    print("n={}, iters={}, density={}".format(n, iters, density))
+    np.random.seed(seed)
+    alg_names = maxflow.get_alg_names()
+    S = maxflow.Solver()
+
+    for i in range(iters):
+        x = (sparse.rand(n,n,density=density,format='csr')*200).astype(np.uint32)
+        x.setdiag(7)
+        x.sort_indices()
+        source, sink = (int(v) for v in np.random.choice(n, 2, replace=False))
+        flow = sparse.csgraph.maximum_flow(x, source, sink).flow_value
+        for x_ in [x, x.tocsc()]:
+            S.load_graph(x_, flow_index=True)
+            for alg in alg_names:
+                flow2, F = S.solve(alg, source, sink, THREADS, return_flow=True)
+                assert type(F) == type(x_) and np.array_equal(F.indices, x_.indices) and np.array_equal(F.indptr, x_.indptr), "Error at iteration:{}! : function {} changes the sparsity pattern".format(i, alg)
+                assert flow == flow2, "Error at iteration:{}! : function {} gives flow:{}, while scipy's maxflow:{}".format(i, alg, flow2, flow)
+                check_flow(F, x, source, sink, flow, "Error at iteration:{}! : function {}".format(i, alg))
+
+        # dense input, and a solve which continues from the previous one after an update
+        for alg in alg_names:
+            fn = getattr(maxflow, alg)
+            flow2, F = fn(x.toarray(), source, sink, THREADS, return_flow=True) if 'parallel' in alg else fn(x.toarray(), source, sink, return_flow=True)
+            check_flow(F, x, source, sink, flow, "Error at iteration:{}! : function {} on a dense array".format(i, alg))
+        S.load_graph(x, flow_index=True)
+        S.solve('push_relabel_highest', source, sink, return_flow=True)
+        u, v = (int(a) for a in np.argwhere((x.toarray() > 0) & ~np.eye(n, dtype=bool))[0])
+        y = x.tolil()
+        y[u, v] = 0
+        S.update_capacities(u, v, 0)
+        flow2, F = S.solve('push_relabel_highest', source, sink, return_flow=True)
+        check_flow(F, y, source, sink, sparse.csgraph.maximum_flow(y.tocsr(), source, sink).flow_value, "Error at iteration:{}! : after an update".format(i))
+
+
+def test_correctness_reorder(n, iters, seed=0, density=0.1):
+    import pickle
+    print("------------Running test_correctness_reorder!--------------")
+    print("n={}, iters={}, density={}".format(n, iters, density))
+    np.random.seed(seed)
+    alg_names = maxflow.get_alg_names()
+    S = maxflow.Solver()
+
+    for i in range(iters):
+        x = (sparse.rand(n,n,density=density,format='csr')*200).astype(np.uint32)
+        source, sink = (int(v) for v in np.random.choice(n, 2, replace=False))
+        flow = sparse.csgraph.maximum_flow(x, source, sink).flow_value
+        for order in ['bfs', 'rcm', 'degree']:
+            S.load_graph(x, flow_index=True, reorder=order, root=sink)
+            for alg in alg_names:
+                flow2, F, mask, edges = S.solve(alg, source, sink, THREADS, return_flow=True, cut_edges=True)
+                assert flow == flow2, "Error at iteration:{}! : function {} with order {} gives flow:{}, while scipy's maxflow:{}".format(i, alg, order, flow2, flow)
+                check_flow(F, x, source, sink, flow, "Error at iteration:{}! : function {} with order {}".format(i, alg, order))
+                assert mask[source] and not mask[sink] and x[mask][:, ~mask].sum() == flow, "Error at iteration:{}! : function {} with order {} gives a wrong cut".format(i, alg, order)
+                assert all(mask[u] and not mask[v] for u, v in edges), "Error at iteration:{}! : function {} with order {} gives wrong cut edges".format(i, alg, order)
+
+            flows = S.solve_many('push_relabel_highest', [source, sink], [sink, source])
+            assert flows[0] == flow and flows[1] == sparse.csgraph.maximum_flow(x, sink, source).flow_value, "Error at iteration:{}! : solve_many with order {}".format(i, order)
+            u, v = (int(a) for a in np.argwhere((x.toarray() > 0) & ~np.eye(n, dtype=bool))[0])
+            y = x.tolil()
+            y[u, v] = 0
+            S2 = pickle.loads(pickle.dumps(S))
+            S2.update_capacities(u, v, 0)
+            assert S2.solve('push_relabel_highest', source, sink) == sparse.csgraph.maximum_flow(y.tocsr(), source, sink).flow_value, "Error at iteration:{}! : update with order {}".format(i, order)
+
+
+def test_correctness_many(n, iters, pairs, seed=0, density=0.5):
+    print("------------Running test_correctness_many!--------------")
+    print("n={}, iters={}, pairs={}, density={}".format(n, iters, pairs, density))
+    np.random.seed(seed)
+    alg_names = maxflow.get_alg_names()
+    S = maxflow.Solver()
+
+    for i in range(iters):
+        x = (sparse.rand(n,n,density=density,format='csr')*200).astype(np.uint32)
+        S.load_graph(x)
+        terminals = np.array([np.random.choice(n, 2, replace=False) for q in range(pairs)])
+        flows = [sparse.csgraph.maximum_flow(x, int(s), int(t)).flow_value for s, t in terminals]
+        for alg in alg_names:
+            flows2 = S.solve_many(alg, terminals[:,0], terminals[:,1], THREADS)
+            assert list(flows2) == flows, "Error at iteration:{}! : function {} gives flows:{}, while scipy's maxflow:{}".format(i, alg, list(flows2), flows)
+
+
+def test_correctness_updates(n, iters, rounds, batch, seed=0, density=0.5):
+    print("------------Running test_correctness_updates!--------------")
+    print("n={}, iters={}, rounds={}, batch={}, density={}".format(n, iters, rounds, batch, density))
+    np.random.seed(seed)
+    alg_names = maxflow.get_alg_names()
+    S = maxflow.Solver()
+
+    for i in range(iters):
+        x = (sparse.rand(n,n,density=density,format='csr')*200).astype(np.uint32).toarray()
+        S.load_graph(x)
+        adjacent = np.argwhere(((x + x.T) > 0) & ~np.eye(n, dtype=bool))
+        for alg in alg_names:
+            # the first solve starts from scratch, the following ones of push_relabel_highest and ahuja_orlin resume
+            for r in range(rounds + 1):
+                flow = sparse.csgraph.maximum_flow(sparse.csr_matrix(x), 0, n-1).flow_value
+                flow2 = S.solve(alg, 0, n-1, THREADS)
+                assert flow == flow2, "Error at iteration:{}! : function {} gives flow:{} after {} updates, while scipy's maxflow:{}".format(i, alg, flow2, r, flow)
+                arcs = adjacent[np.random.choice(len(adjacent), batch)]
+                new_cap = np.random.randint(0, 200, size=batch) * (np.random.rand(batch) < 0.8)
+                x[arcs[:,0], arcs[:,1]] = new_cap
+                S.update_capacities(arcs[:,0], arcs[:,1], new_cap)
+
+    try:
+        S.update_capacities(0, 0, 1)
+        assert False, "update_capacities accepts an arc which is not in the graph"
+    except ValueError:
+        pass
+
+
+def test_correctness_dimacs(n, iters, seed=0, density=0.5):
+    print("------------Running test_correctness_dimacs!--------------")
+    print("n={}, iters={}, density={}".format(n, iters, density))
+    import tempfile, os
+    np.random.seed(seed)
+    alg_names = maxflow.get_alg_names()
+    S = maxflow.Solver()
+
+    with tempfile.TemporaryDirectory() as tmp_dir:
+        filename = os.path.join(tmp_dir, "A.max")
+        for i in range(iters):
+            # scipy's maxflow is limited to int32 capacities, capacities above 2**32 are checked against the sparse loader
+            for scale, dtype in [(200, np.uint32), (2**40, np.uint64)]:
+                x = (sparse.rand(n,n,density=density,format='csr')*scale).astype(dtype)
+                flow = sparse.csgraph.maximum_flow(x, 0, n-1).flow_value if dtype == np.uint32 else maxflow.push_relabel_highest(x, 0, n-1)
+                saveDimacs(x.toarray(), filename)
+                source, sink = S.load_dimacs(filename, THREADS)
+                assert (source, sink) == (0, n-1), "Error at iteration:{}! : load_dimacs returns terminals {}".format(i, (source, sink))
+                for alg in alg_names:
+                    flow2 = S.solve(alg, source, sink, THREADS)
+                    assert flow == flow2, "Error at iteration:{}! : function {} gives flow:{}, while scipy's maxflow:{}".format(i, alg, flow2, flow)
+
+        # every arc fits in 32 bits, but the parallel arcs 2 -> 3 merge into a capacity above 2**32
+        with open(filename, "w") as f:
+            f.write("p max 3 3\nn 1 s\nn 3 t\na 1 2 4000000000\na 2 3 3000000000\na 2 3 3000000000\n")
+        source, sink = S.load_dimacs(filename, THREADS)
+        for alg in alg_names:
+            flow2 = S.solve(alg, source, sink, THREADS)
+            assert flow2 == 4000000000, "Error! : function {} gives flow:{} on parallel arcs above 2**32, instead of 4000000000".format(alg, flow2)
+
+
+def test_correctness_snapshot(n, iters, seed=0, density=0.5):
+    print("------------Running test_correctness_snapshot!--------------")
+    print("n={}, iters={}, density={}".format(n, iters, density))
+    import tempfile, os, pickle
+    np.random.seed(seed)
+    alg_names = maxflow.get_alg_names()
+    S = maxflow.Solver()
+
+    with tempfile.TemporaryDirectory() as tmp_dir:
+        filename = os.path.join(tmp_dir, "A.graph")
+        for i in range(iters):
+            x = (sparse.rand(n,n,density=density,format='csr')*200).astype(np.uint32)
+            flow = sparse.csgraph.maximum_flow(x, 0, n-1).flow_value
+            S.load_graph(x)
+            S.save(filename)
+            S2 = pickle.loads(pickle.dumps(S))
+            S.destroy_graphs()
+            for alg in alg_names:
+                flow2 = S2.solve(alg, 0, n-1, THREADS)
+                assert flow == flow2, "Error at iteration:{}! : function {} on a pickled Solver gives flow:{}, while scipy's maxflow:{}".format(i, alg, flow2, flow)
+            # solving must not modify the snapshot, so it is opened twice
+            for j in range(2):
+                S.open(filename)
+                for alg in alg_names:
+                    flow2 = S.solve(alg, 0, n-1, THREADS)
+                    assert flow == flow2, "Error at iteration:{}! : function {} on a snapshot gives flow:{}, while scipy's maxflow:{}".format(i, alg, flow2, flow)
+
+
 def time_solvers(solver, alg_names, A, source, sink):
     times = np.zeros((len(alg_names), 2))
     for i, name in enumerate(alg_names):
@@ -218,6 +578,11 @@ def bench_Solvers(n, iters, seed=0, density=0.5, dense=True, matrix_generator=ge
 def run(only_correctness=False):
     test_correctness(100, 100, dense=True)
     test_correctness(100, 100, dense=False)
+    test_correctness_memmap(100, 10)
+    test_correctness_sparse_formats(100, 10)
+    test_correctness_gomory_hu(60, 3, 30)
+    test_correctness_gomory_hu(8, 30, 10, density=0.4)
+    test_correctness_grid(10)
 
     if only_correctness:
         return
@@ -239,6 +604,14 @@ def run(only_correctness=False):
 def run_Solver(only_correctness=False):
     test_correctness_Solver(100, 100, dense=True)
     test_correctness_Solver(100, 100, dense=False)
+    test_correctness_queries(100, 10, 10)
+    test_correctness_cut(100, 10)
+    test_correctness_flow(100, 10)
+    test_correctness_reorder(100, 10)
+    test_correctness_many(100, 10, 10)
+    test_correctness_updates(100, 10, 5, 20)
+    test_correctness_dimacs(100, 10)
+    test_correctness_snapshot(100, 10)
 
     if only_correctness:
         return